@@ -0,0 +1,135 @@
+#ifndef BOUNDED_PRIORITY_QUEUE_H
+#define BOUNDED_PRIORITY_QUEUE_H
+
+#include <functional>
+#include "Pair.h"
+
+/**
+ * @brief Classe template que guarda os K menores elementos vistos (top-K), segundo um comparador.
+ *
+ * É um heap de capacidade fixa cujo topo é o pior elemento mantido, ou seja, o K-ésimo menor. Quando cheio,
+ * um elemento melhor que o topo o substitui com uma única descida (replaceTop), em vez de pop seguido de push.
+ * A ordem é definida em tempo de compilação pelo comparador, e as trocas de posição são feitas
+ * iterativamente, deslocando os elementos até a posição final do que sobe ou desce. Ao final, sort ordena o
+ * próprio array do heap, e o resultado é lido em ordem crescente por begin e end, sem cópias.
+ *
+ * @tparam T Tipo de dado armazenado.
+ * @tparam Compare Comparador estrito: Compare()(a, b) é verdadeiro se a é melhor (menor) que b.
+ */
+template <typename T, typename Compare = std::less<T>>
+class BoundedPriorityQueue
+{
+private:
+    T *_heap;      ///< Array que representa o heap, com o pior elemento na raiz
+    int _size;     ///< Número de elementos mantidos
+    int _capacity; ///< Número máximo de elementos mantidos (K)
+    Compare _less; ///< Comparador dos elementos
+
+    /**
+     * @brief Sobe um elemento a partir de uma posição vazia até a posição que mantém a propriedade do heap.
+     * @param index Posição vazia de onde o elemento parte.
+     * @param data Elemento a ser posicionado.
+     */
+    void siftUp(int index, const T &data);
+
+    /**
+     * @brief Desce um elemento a partir de uma posição vazia até a posição que mantém a propriedade do heap.
+     * @param index Posição vazia de onde o elemento parte.
+     * @param data Elemento a ser posicionado.
+     */
+    void siftDown(int index, const T &data);
+
+public:
+    /**
+     * @brief Construtor que reserva espaço para K elementos.
+     * @param capacity Número máximo de elementos mantidos.
+     */
+    BoundedPriorityQueue(int capacity);
+
+    /**
+     * @brief Destrutor da classe BoundedPriorityQueue.
+     */
+    ~BoundedPriorityQueue();
+
+    /**
+     * @brief Adiciona um elemento à fila, que não pode estar cheia.
+     * @param data Elemento a ser adicionado.
+     * @details Lança uma exceção se a fila estiver cheia.
+     */
+    void push(const T &data);
+
+    /**
+     * @brief Substitui o pior elemento mantido por outro em uma única operação.
+     * @param data Elemento que entra no lugar do topo.
+     * @details Lança uma exceção se a fila estiver vazia.
+     */
+    void replaceTop(const T &data);
+
+    /**
+     * @brief Oferece um elemento: ele entra se a fila não estiver cheia ou se for melhor que o pior mantido.
+     * @param data Elemento oferecido.
+     * @return true se o elemento foi mantido, false caso contrário.
+     */
+    bool offer(const T &data);
+
+    /**
+     * @brief Obtém o pior elemento mantido.
+     * @return Referência constante para o topo, válida até a próxima modificação da fila.
+     */
+    const T &top() const;
+
+    /**
+     * @brief Remove o pior elemento mantido.
+     */
+    void pop();
+
+    /**
+     * @brief Ordena os elementos mantidos em ordem crescente, no próprio array do heap (heap sort).
+     * @details Depois da ordenação o array deixa de ser um heap: os elementos devem ser lidos por begin e end,
+     * e a fila só volta a aceitar operações de heap após clear.
+     */
+    void sort();
+
+    /**
+     * @brief Remove todos os elementos, mantendo a capacidade.
+     */
+    void clear();
+
+    /**
+     * @brief Retorna o início do array de elementos, em ordem crescente após sort.
+     * @return Ponteiro para o primeiro elemento.
+     */
+    const T *begin() const;
+
+    /**
+     * @brief Retorna a posição logo após o último elemento.
+     * @return Ponteiro para o fim do array de elementos.
+     */
+    const T *end() const;
+
+    /**
+     * @brief Verifica se a fila está vazia.
+     * @return true se a fila estiver vazia, false caso contrário.
+     */
+    bool empty() const;
+
+    /**
+     * @brief Verifica se a fila já mantém K elementos.
+     * @return true se a fila estiver cheia, false caso contrário.
+     */
+    bool full() const;
+
+    /**
+     * @brief Retorna o número de elementos mantidos.
+     * @return O número de elementos.
+     */
+    int size() const;
+
+    /**
+     * @brief Retorna o número máximo de elementos mantidos.
+     * @return A capacidade (K).
+     */
+    int capacity() const;
+};
+
+#endif // BOUNDED_PRIORITY_QUEUE_H
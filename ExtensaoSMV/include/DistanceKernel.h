@@ -0,0 +1,57 @@
+#ifndef DISTANCE_KERNEL_H
+#define DISTANCE_KERNEL_H
+
+/**
+ * @file DistanceKernel.h
+ * @brief Cálculo vetorizado do quadrado das distâncias entre um ponto e um bloco de coordenadas.
+ *
+ * As coordenadas ficam em dois vetores separados (x e y, struct-of-arrays), de modo que cada instrução
+ * vetorial processa 2 (SSE2) ou 4 (AVX2) pontos. A implementação é escolhida em tempo de execução, pela
+ * melhor que o processador suporta, com uma versão escalar para os demais casos. Todas somam dx² + dy² na
+ * mesma ordem e sem FMA, portanto produzem exatamente os mesmos valores.
+ */
+
+/**
+ * @brief Implementações disponíveis do cálculo de distâncias.
+ */
+enum DistanceKernel
+{
+    SCALAR_KERNEL, /**< Um ponto por vez */
+    SSE2_KERNEL,   /**< Dois pontos por instrução (x86-64) */
+    AVX2_KERNEL    /**< Quatro pontos por instrução (x86 com AVX2) */
+};
+
+/**
+ * @brief Calcula out[i] = (xs[i] - px)² + (ys[i] - py)² para i em [0, n), com a implementação selecionada.
+ * @param xs Coordenadas X do bloco.
+ * @param ys Coordenadas Y do bloco.
+ * @param n Número de pontos do bloco.
+ * @param px Coordenada X do ponto de referência.
+ * @param py Coordenada Y do ponto de referência.
+ * @param out Vetor com pelo menos n posições que recebe os quadrados das distâncias.
+ */
+void squaredDistances(const double *xs, const double *ys, int n, double px, double py, double *out);
+
+/**
+ * @brief Retorna a melhor implementação suportada pelo processador.
+ */
+DistanceKernel bestDistanceKernel();
+
+/**
+ * @brief Seleciona a implementação usada por squaredDistances.
+ * @param kernel A implementação desejada.
+ * @return false, mantendo a seleção atual, se o processador não suportar a implementação.
+ */
+bool setDistanceKernel(DistanceKernel kernel);
+
+/**
+ * @brief Retorna a implementação selecionada.
+ */
+DistanceKernel currentDistanceKernel();
+
+/**
+ * @brief Retorna o nome de uma implementação, para relatórios.
+ */
+const char *distanceKernelName(DistanceKernel kernel);
+
+#endif // DISTANCE_KERNEL_H
@@ -0,0 +1,54 @@
+/**
+ * @file PageTrace.h
+ * @brief Formato binário do traço de referências a páginas gravado pelo SMV.
+ *
+ * O arquivo começa com um PageTraceHeader, seguido de um registro de 32 bits por referência, na ordem em
+ * que ocorreram: o índice da página deslocado de um bit, com o bit menos significativo indicando escrita.
+ * Faltas seguidas na mesma página (carga, liberação para leitura e para escrita) formam uma única
+ * referência, de modo que o traço não depende da quantidade de memória com que foi gravado.
+ */
+
+#ifndef PAGE_TRACE_H
+#define PAGE_TRACE_H
+
+#include <cstdint>
+
+#define PAGETRACEMAGIC 0x54564D53u /* "SMVT" em little-endian */
+#define PAGETRACEVERSION 1
+
+/**
+ * @brief Cabeçalho do traço.
+ */
+struct PageTraceHeader
+{
+    uint32_t magic = PAGETRACEMAGIC;     /**< Identifica o arquivo como um traço do SMV */
+    uint32_t version = PAGETRACEVERSION; /**< Versão do formato */
+    uint32_t numPages = 0;               /**< NUMPAGE do SMV que gravou o traço */
+    uint32_t pageSize = 0;               /**< PAGESIZE do SMV que gravou o traço */
+};
+
+/**
+ * @brief Monta o registro de uma referência.
+ */
+inline uint32_t pageTraceRecord(int page, bool write)
+{
+    return (static_cast<uint32_t>(page) << 1) | (write ? 1u : 0u);
+}
+
+/**
+ * @brief Página referenciada por um registro.
+ */
+inline int pageTracePage(uint32_t record)
+{
+    return static_cast<int>(record >> 1);
+}
+
+/**
+ * @brief Indica se a referência de um registro incluiu uma escrita.
+ */
+inline bool pageTraceWrite(uint32_t record)
+{
+    return record & 1u;
+}
+
+#endif
@@ -29,17 +29,17 @@ public:
 
     /**
      * @brief Retorna o primeiro elemento do par.
-     * @return O primeiro elemento do par.
+     * @return Referência constante para o primeiro elemento do par.
      */
-    T1 getFirst() const {
+    const T1 &getFirst() const {
         return first;
     }
 
     /**
      * @brief Retorna o segundo elemento do par.
-     * @return O segundo elemento do par.
+     * @return Referência constante para o segundo elemento do par.
      */
-    T2 getSecond() const {
+    const T2 &getSecond() const {
         return second;
     }
 
@@ -11,65 +11,101 @@
 
 #include <iostream>
 #include <cmath>
+#include <cstdint>
+#include <vector>
 #include "Point.h"
 #include "Rectangle.h"
 #include "PriorityQueue.h"
 #include "Pair.h"
 #include "SMV.h"
 
-#define INVALIDKEY -1  /**< Definição para chave inválida */
 #define INVALIDADDR -2 /**< Definição para endereço inválido */
+#define INVALIDBUCKET -1 /**< Definição para nó sem balde */
+#define MAXBUCKETSIZE 256 /**< Maior número de pontos em um balde */
 
-using quadnodekey_t = long;  /**< Tipo de dado para a chave de QuadNode */
-using quadnodeaddr_t = long; /**< Tipo de dado para o endereço de QuadNode */
+using quadnodeaddr_t = int32_t; /**< Tipo de dado para o endereço de QuadNode */
+
+/**
+ * @brief Quadrantes de um nó, na ordem em que são testados por QuadNodeManager::localize.
+ */
+enum Quadrant
+{
+    NE,
+    NW,
+    SW,
+    SE
+};
 
 /**
  * @class QuadNode
  * @brief Classe que representa um nó da QuadTree.
  *
- * A classe QuadNode é usada para armazenar os limites espaciais de um retângulo e os ponteiros para seus nós filhos (NE, NW, SE, SW).
- * Cada nó contém um ponto associado e pode ser dividido em quatro quadrantes.
+ * O nó guarda apenas os dados lidos durante o percurso da árvore: as coordenadas do ponto, os limites do nó,
+ * os endereços dos filhos (NE, NW, SE, SW) e o número de pontos ativos na subárvore. O índice da estação do
+ * ponto no StationArena, usado apenas para montar as respostas, fica no vetor stations do QuadNodeManager, no
+ * mesmo índice do nó.
+ * Os limites são guardados em float, arredondados para fora, e por isso continuam sendo limites válidos para
+ * a menor distância entre um ponto e a subárvore. Com esse formato um nó ocupa no máximo 64 bytes e cabem
+ * várias vezes mais nós em cada página do SMV.
+ *
+ * Um nó sem ponto é uma folha, que guarda até B pontos em um balde e só é dividida quando o balde transborda.
+ * O balde guarda apenas as coordenadas, 16 bytes por ponto, e por isso cada página do SMV ocupada por baldes
+ * contém quatro vezes mais estações do que uma página de nós.
+ *
+ * Nós excluídos formam a lista de nós livres do QuadNodeManager, encadeada pelo campo ne, como firstavail no
+ * vetor de nós da implementação em C.
  */
-class QuadNode
+class alignas(64) QuadNode
 {
 private:
-    Rectangle _boundary; /**< Limites espaciais do nó, representado por um retângulo */
-    quadnodekey_t key;   /**< Chave única associada ao nó */
-    quadnodeaddr_t ne;   /**< Endereço do nó filho nordeste */
-    quadnodeaddr_t nw;   /**< Endereço do nó filho noroeste */
-    quadnodeaddr_t se;   /**< Endereço do nó filho sudeste */
-    quadnodeaddr_t sw;   /**< Endereço do nó filho sudoeste */
-    Point *_point;       /**< Ponto armazenado neste nó */
+    double _x;                  /**< Coordenada X do ponto armazenado neste nó */
+    double _y;                  /**< Coordenada Y do ponto armazenado neste nó */
+    float _lbx, _lby;           /**< Canto inferior esquerdo dos limites, arredondado para baixo */
+    float _rtx, _rty;           /**< Canto superior direito dos limites, arredondado para cima */
+    quadnodeaddr_t ne;          /**< Endereço do nó filho nordeste */
+    quadnodeaddr_t nw;          /**< Endereço do nó filho noroeste */
+    quadnodeaddr_t se;          /**< Endereço do nó filho sudeste */
+    quadnodeaddr_t sw;          /**< Endereço do nó filho sudoeste */
+    int32_t _activeCount;       /**< Número de pontos ativos na subárvore enraizada neste nó */
+    int32_t _pointCount;        /**< Número de pontos, ativos ou não, na subárvore enraizada neste nó */
+    int32_t _bucket;            /**< Balde com os pontos da folha, ou INVALIDBUCKET */
+    int16_t _bucketCount;       /**< Número de pontos no balde */
+    bool _hasPoint;             /**< Indica se o nó armazena um ponto */
+    bool _active;               /**< Indica se o ponto armazenado neste nó está ativo */
 
     /**
      * @brief Construtor privado da classe QuadNode.
      *
-     * Inicializa um QuadNode com valores padrão ou especificados.
+     * Inicializa um QuadNode sem ponto e sem filhos.
      *
      * @param boundary Retângulo que define os limites do nó.
-     * @param key Chave associada ao nó.
-     * @param ne Endereço do nó filho nordeste.
-     * @param nw Endereço do nó filho noroeste.
-     * @param se Endereço do nó filho sudeste.
-     * @param sw Endereço do nó filho sudoeste.
-     * @param ponto Ponteiro para o ponto armazenado neste nó.
      */
-    QuadNode(Rectangle boundary = Rectangle(), quadnodekey_t key = INVALIDKEY,
-             quadnodeaddr_t ne = INVALIDADDR, quadnodeaddr_t nw = INVALIDADDR,
-             quadnodeaddr_t se = INVALIDADDR, quadnodeaddr_t sw = INVALIDADDR,
-             Point *ponto = nullptr);
+    QuadNode(const Rectangle &boundary = Rectangle());
 
     /**
      * @brief Redefine os valores do nó para os padrões.
      *
-     * Reseta o conteúdo do nó, desassociando chaves e pontos.
+     * Reseta o conteúdo do nó, desassociando filhos e pontos.
      */
     void reset();
 
+    /**
+     * @brief Calcula o quadrado da distância euclidiana entre o ponto armazenado no nó e outro ponto.
+     *
+     * @param p O ponto de referência.
+     * @return O quadrado da distância entre os dois pontos.
+     */
+    double distanceSquared(const Point &p) const;
+
     friend class QuadNodeManager;
     friend class QuadTree;
 };
 
+// Com exatamente 64 bytes, um nó ocupa uma linha de cache e nenhum nó cruza a fronteira entre duas páginas do SMV,
+// que só mantém uma página acessível por vez e não conseguiria atender um acesso dividido entre duas páginas.
+static_assert(PAGESIZE % sizeof(QuadNode) == 0, "QuadNode não pode cruzar páginas do SMV");
+static_assert(sizeof(QuadNode) == 64, "QuadNode deve ocupar uma linha de cache");
+
 /**
  * @class QuadNodeManager
  * @brief Classe responsável pelo gerenciamento de nós QuadNode.
@@ -81,25 +117,83 @@ class QuadNodeManager
 {
 private:
     QuadNode *nodes;  /**< Vetor de QuadNodes gerenciados */
-    size_t _size;     /**< Tamanho atual do vetor de nós */
+    stationidx_t *stations; /**< Vetor com a estação do ponto de cada nó, indexado pelo endereço do nó */
+    size_t _size;     /**< Número de posições do vetor de nós já usadas, incluindo os nós livres */
     size_t _capacity; /**< Capacidade máxima do vetor de nós */
+    quadnodeaddr_t firstAvail; /**< Primeiro nó da lista de nós livres */
+    size_t _numFree;  /**< Número de nós na lista de nós livres */
     SMV* smv;          /**< Instância da classe SMV para gerenciar memória virtual */
 
+    // Os baldes ocupam as páginas do SMV a partir da última, e os nós a partir da primeira: a memória acaba
+    // quando as duas regiões se encontram. Cada balde guarda as coordenadas X e depois as Y de seus pontos,
+    // contíguas e sem cruzar páginas; a estação e o estado de cada ponto ficam fora do SMV, como em stations.
+    int _bucketSize;                          /**< Número máximo de pontos em um balde (B); 0 desativa os baldes */
+    int32_t _numBuckets;                      /**< Número de baldes criados */
+    std::vector<stationidx_t> bucketStations; /**< Estação de cada ponto dos baldes, B posições por balde */
+    std::vector<uint8_t> bucketActive;        /**< Indica se cada ponto dos baldes está ativo */
+    std::vector<int32_t> freeBuckets;         /**< Baldes liberados, reaproveitados antes de criar novos */
+
+    /**
+     * @brief Determina o quadrante de um nó que contém um ponto, sem construir os retângulos dos quadrantes.
+     *
+     * O ponto deve estar contido nos limites do nó.
+     *
+     * @param addr Endereço do nó cujo ponto define a divisão.
+     * @param p Ponto a ser classificado.
+     * @return O quadrante (NE, NW, SW ou SE).
+     */
+    int quadrant(quadnodeaddr_t addr, const Point &p) const;
+
+    /**
+     * @brief Constrói os limites de um quadrante de um nó.
+     *
+     * @param addr Endereço do nó cujo ponto define a divisão.
+     * @param q O quadrante desejado.
+     * @return O retângulo correspondente ao quadrante.
+     */
+    Rectangle quadrantBoundary(quadnodeaddr_t addr, int q) const;
+
+    /**
+     * @brief Calcula quantas páginas do SMV, contadas a partir da última, estão reservadas para baldes.
+     *
+     * @param numBuckets Número de baldes.
+     * @return O número de páginas.
+     */
+    size_t bucketPages(int32_t numBuckets) const;
+
+    /**
+     * @brief Retorna as coordenadas de um balde na memória do SMV.
+     *
+     * @param bucket Índice do balde.
+     * @return Ponteiro para as B coordenadas X do balde, seguidas das B coordenadas Y.
+     */
+    double *bucketCoords(int32_t bucket) const;
+
+    /**
+     * @brief Obtém um balde livre, criando-o se necessário.
+     *
+     * Lança uma exceção se o novo balde ocupar uma página usada por nós.
+     *
+     * @return O índice do balde.
+     */
+    int32_t createBucket();
+
 public:
     /**
      * @brief Inicializa o gerenciador de nós com uma capacidade específica.
      *
      * @param capacity Capacidade inicial para o vetor de nós.
+     * @param bucketSize Número máximo de pontos no balde de cada folha; 0 guarda um ponto por nó.
      */
-    void initialize(long capacity);
+    void initialize(long capacity, int bucketSize = 0);
 
     /**
-     * @brief Destroi o gerenciador de nós, liberando todos os recursos alocados.
+     * @brief Destroi o gerenciador de nós, liberando todos os recursos alocados. Chamadas seguintes não têm efeito.
      */
     void destroy();
 
     /**
-     * @brief Cria um novo nó QuadNode no vetor de nós.
+     * @brief Cria um novo nó QuadNode no vetor de nós, reaproveitando um nó livre se houver.
      *
      * @param pn Referência para o nó a ser criado.
      * @return Endereço do novo nó criado.
@@ -109,17 +203,35 @@ public:
     /**
      * @brief Exclui um nó QuadNode com base no endereço fornecido.
      *
-     * @param addr Endereço do nó a ser excluído.
+     * O balde do nó é liberado e o nó passa a ser o primeiro da lista de nós livres.
+     *
+     * @param addr Endereço do nó a ser excluído, que não pode ser filho de outro nó.
      */
     void deleteNode(quadnodeaddr_t addr);
 
     /**
-     * @brief Retorna uma cópia de um nó QuadNode com base no endereço fornecido.
+     * @brief Retorna uma referência constante para um nó QuadNode, sem copiá-lo.
      *
      * @param addr Endereço do nó a ser recuperado.
      * @return O nó QuadNode correspondente ao endereço fornecido.
      */
-    QuadNode getNode(quadnodeaddr_t addr) const;
+    const QuadNode &getNode(quadnodeaddr_t addr) const;
+
+    /**
+     * @brief Retorna o ponto armazenado em um nó.
+     *
+     * @param addr Endereço do nó.
+     * @return Cópia do ponto, montada a partir do nó e do índice de sua estação.
+     */
+    Point getPoint(quadnodeaddr_t addr) const;
+
+    /**
+     * @brief Armazena um ponto em um nó, copiando suas coordenadas e seu estado para o nó.
+     *
+     * @param addr Endereço do nó.
+     * @param p Ponto a ser armazenado.
+     */
+    void setPoint(quadnodeaddr_t addr, const Point &p);
 
     /**
      * @brief Atualiza um nó QuadNode em um endereço específico.
@@ -129,6 +241,82 @@ public:
      */
     void putNode(quadnodeaddr_t addr, QuadNode &pn);
 
+    /**
+     * @brief Verifica se um nó armazena um ponto, comparando a estação e as coordenadas.
+     *
+     * @param addr Endereço do nó.
+     * @param p Ponto procurado.
+     * @return true se o nó armazena p.
+     */
+    bool holds(quadnodeaddr_t addr, const Point &p) const;
+
+    /**
+     * @brief Acrescenta um ponto ao balde de uma folha, que não pode estar cheio.
+     *
+     * @param addr Endereço da folha.
+     * @param p Ponto a ser acrescentado.
+     */
+    void addToBucket(quadnodeaddr_t addr, const Point &p);
+
+    /**
+     * @brief Retira todos os pontos do balde de uma folha e libera o balde.
+     *
+     * @param addr Endereço da folha.
+     * @param out Vetor que recebe os pontos retirados.
+     */
+    void takeBucket(quadnodeaddr_t addr, std::vector<Point> &out);
+
+    /**
+     * @brief Remove um ponto do balde de uma folha, colocando o último ponto do balde em seu lugar.
+     *
+     * O balde é liberado quando fica vazio.
+     *
+     * @param addr Endereço da folha.
+     * @param slot Posição do ponto no balde, como retornada por bucketSlot.
+     */
+    void removeFromBucket(quadnodeaddr_t addr, int slot);
+
+    /**
+     * @brief Procura um ponto no balde de uma folha, comparando a estação e as coordenadas.
+     *
+     * @param addr Endereço da folha.
+     * @param p Ponto procurado.
+     * @return A posição do ponto no balde, ou -1 se ele não estiver no balde.
+     */
+    int bucketSlot(quadnodeaddr_t addr, const Point &p) const;
+
+    /**
+     * @brief Retorna um ponto do balde de uma folha.
+     *
+     * @param leaf A folha.
+     * @param slot Posição do ponto no balde.
+     * @return Cópia do ponto.
+     */
+    Point getBucketPoint(const QuadNode &leaf, int slot) const;
+
+    /**
+     * @brief Renumera os nós, movendo cada nó (e sua estação) para o novo endereço e atualizando os filhos.
+     *
+     * Os baldes são regravados na nova ordem das folhas, sem os baldes liberados.
+     *
+     * @param newAddr Novo endereço de cada nó, indexado pelo endereço atual; deve ser uma permutação de 0.._size-1.
+     */
+    void permute(const std::vector<quadnodeaddr_t> &newAddr);
+
+    /**
+     * @brief Descarta os nós a partir de um endereço e esvazia a lista de nós livres.
+     *
+     * @param size Novo número de nós; todos os nós a partir dele devem estar livres.
+     */
+    void truncate(size_t size);
+
+    /**
+     * @brief Retorna o número de nós em uso, sem contar os nós livres.
+     *
+     * @return O número de nós.
+     */
+    size_t size() const;
+
     /**
      * @brief Localiza um nó com base em um ponto específico.
      *
@@ -138,6 +326,15 @@ public:
      */
     quadnodeaddr_t localize(quadnodeaddr_t addr, const Point &p);
 
+    /**
+     * @brief Retorna o filho de um nó cujo quadrante contém um ponto, sem criar nós.
+     *
+     * @param addr Endereço do nó pai.
+     * @param p Ponto a ser localizado.
+     * @return O endereço do filho, ou INVALIDADDR se ele não existir.
+     */
+    quadnodeaddr_t child(quadnodeaddr_t addr, const Point &p) const;
+
     /**
      * @class QuadNodeManagerException
      * @brief Classe de exceção específica para erros no QuadNodeManager.
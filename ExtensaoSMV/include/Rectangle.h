@@ -1,4 +1,5 @@
 #include "Point.h"
+#include <algorithm>
 
 /**
  * @class Rectangle
@@ -12,19 +13,50 @@ private:
     Point _lb, _rt;
 public:
 
-    Rectangle(Point _lb = Point(0, 0), Point _rt = Point(0, 0)) : _lb(_lb), _rt(_rt) {}
+    Rectangle(const Point &_lb = Point(0, 0), const Point &_rt = Point(0, 0)) : _lb(_lb), _rt(_rt) {}
 
     bool contains(const Point &p) const
     {
         return (p.getX() >= this->_lb.getX() && p.getX() <= this->_rt.getX() && p.getY() >= this->_lb.getY() && p.getY() <= this->_rt.getY());
     }
 
-    Point getLB() const
+    /**
+     * @brief Calcula a menor distância entre um ponto e o retângulo (MINDIST).
+     *
+     * Se o ponto estiver contido no retângulo a distância é zero. Esse valor é um limite inferior
+     * para a distância entre o ponto e qualquer outro ponto contido no retângulo.
+     *
+     * @param p O ponto de referência.
+     * @return A menor distância euclidiana entre o ponto e o retângulo.
+     */
+    double minDistance(const Point &p) const
+    {
+        return sqrt(minDistanceSquared(p));
+    }
+
+    /**
+     * @brief Calcula o quadrado da menor distância entre um ponto e o retângulo.
+     *
+     * O ponto mais próximo do retângulo é obtido limitando cada coordenada de p aos lados do retângulo
+     * com min e max, sem desvios condicionais, e a raiz não é calculada: a comparação entre distâncias
+     * ao quadrado tem o mesmo resultado que entre as distâncias.
+     *
+     * @param p O ponto de referência.
+     * @return O quadrado da menor distância euclidiana entre o ponto e o retângulo.
+     */
+    double minDistanceSquared(const Point &p) const
+    {
+        double dx = p.getX() - std::min(std::max(p.getX(), this->_lb.getX()), this->_rt.getX());
+        double dy = p.getY() - std::min(std::max(p.getY(), this->_lb.getY()), this->_rt.getY());
+        return dx * dx + dy * dy;
+    }
+
+    const Point &getLB() const
     {
         return _lb;
     }
 
-    Point getRT() const
+    const Point &getRT() const
     {
         return _rt;
     }
@@ -0,0 +1,101 @@
+/**
+ * @file ReplacementPolicy.h
+ * @brief Políticas de substituição de páginas do SMV.
+ *
+ * Uma política acompanha as páginas que estão em memória e escolhe qual delas sai quando o SMV precisa abrir
+ * espaço para carregar outra. Ela só enxerga as faltas de página tratadas pelo SMV, que são os únicos acessos
+ * observáveis: uma falta em uma página diferente da anterior é uma nova referência, que é um acerto se a
+ * página está em memória e uma carga se está no disco. As faltas seguintes na mesma página (liberação para
+ * leitura e para escrita) não são novas referências, mas revelam se a página foi escrita. As políticas não
+ * dependem do SMV, de modo que também podem ser usadas sobre um traço de acessos.
+ */
+
+#ifndef REPLACEMENT_POLICY_H
+#define REPLACEMENT_POLICY_H
+
+#include <string>
+
+/**
+ * @brief Políticas de substituição disponíveis.
+ */
+enum ReplacementPolicyKind
+{
+    LRU_POLICY,           /**< Sai a página acessada há mais tempo */
+    CLOCK_POLICY,         /**< Ponteiro circular com bit de referência */
+    SECOND_CHANCE_POLICY, /**< Relógio com bits de referência e de modificação, preferindo páginas limpas */
+    TWOQ_POLICY,          /**< 2Q: fila FIFO de entrada, fila fantasma e LRU das páginas reacessadas */
+    ARC_POLICY,           /**< Adaptive Replacement Cache: equilíbrio adaptativo entre recência e frequência */
+    LFU_POLICY,           /**< Sai a página com menos acessos desde que foi carregada */
+    RANDOM_POLICY         /**< Sai uma página em memória sorteada */
+};
+
+#define NUMREPLACEMENTPOLICIES 7
+
+/**
+ * @class ReplacementPolicy
+ * @brief Interface das políticas de substituição de páginas.
+ *
+ * Para cada referência, o SMV chama access, se a página já está em memória, ou evict (quando a memória
+ * está cheia) seguido de load, se a página está no disco, e modify quando a página é escrita. As páginas
+ * são identificadas pelo índice em [0, numPages).
+ */
+class ReplacementPolicy
+{
+public:
+    virtual ~ReplacementPolicy() {}
+
+    /**
+     * @brief Registra uma nova referência a uma página que está em memória.
+     *
+     * @param page Índice da página.
+     */
+    virtual void access(int page) = 0;
+
+    /**
+     * @brief Registra que uma página em memória foi escrita desde a carga.
+     *
+     * @param page Índice da página.
+     */
+    virtual void modify(int) {}
+
+    /**
+     * @brief Registra que uma página foi carregada do disco para a memória.
+     *
+     * @param page Índice da página, que não pode estar em memória.
+     */
+    virtual void load(int page) = 0;
+
+    /**
+     * @brief Escolhe a página que sai da memória e deixa de acompanhá-la como página em memória.
+     *
+     * @param incoming Página que será carregada em seguida, usada pelas políticas adaptativas.
+     * @return Índice da página escolhida, ou -1 se não há páginas em memória.
+     */
+    virtual int evict(int incoming) = 0;
+};
+
+/**
+ * @brief Cria uma política de substituição.
+ *
+ * @param kind A política desejada.
+ * @param numPages Número total de páginas.
+ * @param capacity Número máximo de páginas em memória, usado para dimensionar as filas de 2Q e ARC.
+ * @return A política, que deve ser liberada com delete.
+ */
+ReplacementPolicy *createReplacementPolicy(ReplacementPolicyKind kind, int numPages, int capacity);
+
+/**
+ * @brief Converte o nome de uma política (lru, clock, second-chance, 2q, arc, lfu, random) no seu tipo.
+ *
+ * @param name O nome da política.
+ * @param kind Recebe o tipo da política.
+ * @return false se o nome não corresponde a nenhuma política.
+ */
+bool parseReplacementPolicy(const std::string &name, ReplacementPolicyKind &kind);
+
+/**
+ * @brief Retorna o nome de uma política, no formato aceito por parseReplacementPolicy.
+ */
+const char *replacementPolicyName(ReplacementPolicyKind kind);
+
+#endif
@@ -30,13 +30,18 @@
 #include <cerrno>
 #include <cmath>
 #include <random>
-#include <chrono>
+#include <string>
+#include <vector>
+#include "ReplacementPolicy.h"
+#include "PageTrace.h"
 
 #ifndef PAGESIZE
 #define PAGESIZE 4096
 #endif
 
+#ifndef NUMPAGE
 #define NUMPAGE 10
+#endif
 
 #ifndef CUSTOM_MEMTOSWAPRATIO
 #ifndef MEMTOSWAPRATIO
@@ -63,7 +68,7 @@ public:
     int navail = 0; /**< Número de vezes que a página ficou disponível */
     int nread = 0;  /**< Número de vezes que a leitura foi permitida */
     int ndisk = 0;  /**< Número de vezes que a página foi escrita no disco */
-    unsigned long lastAccessTime;
+    bool modified = false; /**< Se a página foi escrita desde que foi carregada do disco */
 };
 
 /**
@@ -72,7 +77,14 @@ public:
  *
  * A classe SMV implementa funcionalidades necessárias para inicializar e finalizar páginas de memória,
  * além de tratar exceções de segmentação. Também gerencia o vetor de páginas, controlando o acesso e a troca
- * de páginas entre a memória principal e a memória secundária utilizando a política LRU.
+ * de páginas entre a memória principal e a memória secundária.
+ *
+ * A página que sai da memória é escolhida por uma ReplacementPolicy (LRU por padrão), definida antes da
+ * inicialização, assim como a razão entre memória principal e secundária. Só as páginas escritas desde que
+ * foram carregadas voltam para o disco; as demais já têm uma cópia idêntica no swap.
+ *
+ * A cada falta, apenas as páginas abertas desde a falta anterior (openPages) são copiadas para a memória
+ * física e protegidas de novo, de modo que o custo de uma falta não depende de NUMPAGE.
  */
 class SMV
 {
@@ -124,6 +136,32 @@ public:
      */
     static void setMemToSwapRatio(double ratio);
 
+    /**
+     * @brief Obtém a política de substituição de páginas.
+     *
+     * @return Retorna a política usada para escolher a página que sai da memória.
+     */
+    static ReplacementPolicyKind getReplacementPolicy();
+
+    /**
+     * @brief Define a política de substituição de páginas.
+     *
+     * A definição da política deve ocorrer antes da inicialização do sistema de memória.
+     *
+     * @param kind A política usada para escolher a página que sai da memória.
+     */
+    static void setReplacementPolicy(ReplacementPolicyKind kind);
+
+    /**
+     * @brief Define o arquivo em que as referências a páginas são gravadas.
+     *
+     * Quando definido antes da inicialização do sistema de memória, cada falta de página é registrada no
+     * formato de PageTrace.h, para ser reproduzida depois com outras políticas e quantidades de memória.
+     *
+     * @param path Caminho do arquivo do traço.
+     */
+    static void setTraceFile(const std::string &path);
+
 private:
     /**
      * @brief Construtor da classe SMV.
@@ -168,6 +206,42 @@ private:
      */
     static void handleSegv(int sig, siginfo_t *sip, void *context);
 
+    /**
+     * @brief Registra no traço uma referência a uma página.
+     *
+     * Faltas seguidas na mesma página são acumuladas em um único registro, que só vai para o buffer quando
+     * outra página é referenciada.
+     *
+     * @param i Índice da página.
+     * @param newReference Verdadeiro se a falta anterior foi em outra página.
+     * @param writing Verdadeiro se a falta é uma escrita.
+     */
+    void traceReference(int i, bool newReference, bool writing);
+
+    /**
+     * @brief Fecha as páginas abertas desde a falta anterior.
+     *
+     * As páginas DIRTY são copiadas para a memória física e voltam a VALID, as páginas em READ voltam a AVAIL
+     * (exceto a página da falta atual, cuja falta em READ é uma escrita), e todas voltam a PROT_NONE.
+     *
+     * @param i Índice da página da falta atual.
+     */
+    void closeOpenPages(int i);
+
+    /**
+     * @brief Grava uma página que sai da memória na área de troca, se ela foi escrita desde a carga.
+     *
+     * Páginas limpas já têm uma cópia idêntica no swap e só são contadas em cleanWriteBacks.
+     *
+     * @param i Índice da página.
+     */
+    void writeBack(int i);
+
+    /**
+     * @brief Grava no arquivo do traço os registros acumulados no buffer.
+     */
+    void flushTrace();
+
     SMVPage pvet[NUMPAGE];         /**< Vetor de páginas de memória virtual */
     char *raw_physpage = nullptr;  /**< Endereço da memória física bruta */
     char *raw_logpage = nullptr;   /**< Endereço da memória lógica bruta */
@@ -175,8 +249,18 @@ private:
     char *logpage = nullptr;       /**< Endereço da memória lógica */
     int swap = -1;                 /**< Descritor de arquivo para swap */
     int pagesInMemory = 0;         /**< Número de páginas atualmente na memória */
+    long cleanWriteBacks = 0;      /**< Páginas que saíram da memória sem precisar ser gravadas no disco */
+    std::vector<int> openPages;    /**< Páginas em READ ou DIRTY, as únicas que não estão em PROT_NONE */
+    ReplacementPolicy *policy = nullptr; /**< Política que escolhe a página que sai da memória */
+    int trace = -1;                      /**< Descritor do arquivo do traço, ou -1 se não há traço */
+    std::vector<uint32_t> traceBuffer;   /**< Registros do traço ainda não gravados */
+    int lastFaultPage = -1;              /**< Página da falta anterior, ou -1 */
+    int tracePage = -1;                  /**< Página do registro em andamento, ou -1 */
+    bool traceWrite = false;             /**< Se a referência em andamento incluiu uma escrita */
     static SMV *instance;          /**< Instância única da classe SMV */
     static double _MEMTOSWAPRATIO; /**< Razão entre memória principal e memória secundária */
+    static ReplacementPolicyKind _POLICY; /**< Política de substituição de páginas */
+    static std::string _TRACEFILE;        /**< Arquivo do traço, ou vazio se não há traço */
 
     // Previne a cópia e a atribuição
     SMV(const SMV &) = delete;
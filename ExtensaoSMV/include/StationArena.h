@@ -0,0 +1,92 @@
+#ifndef STATIONARENA_H
+#define STATIONARENA_H
+
+#include <vector>
+#include "Point.h"
+#include "Address.h"
+
+/**
+ * @class StationArena
+ * @brief Armazena de forma contígua todas as estações da base: o texto do arquivo, os pontos e os endereços.
+ *
+ * A estação de índice i é formada por point(i) e address(i). A árvore e a tabela hash guardam apenas esse
+ * índice de 32 bits, e os campos de texto dos endereços apontam para o próprio conteúdo do arquivo. Assim
+ * toda a base ocupa três blocos de memória, liberados de uma vez com o StationArena.
+ */
+class StationArena
+{
+private:
+    std::vector<char> _text;             ///< Conteúdo da base, com os campos terminados por '\0'
+    std::vector<Point> _points;          ///< Ponto de cada estação
+    std::vector<AddressInfo> _addresses; ///< Endereço de cada estação
+
+public:
+    /**
+     * @brief Construtor que reserva espaço para um número de estações.
+     * @param capacity Número esperado de estações.
+     */
+    explicit StationArena(size_t capacity)
+    {
+        _points.reserve(capacity);
+        _addresses.reserve(capacity);
+    }
+
+    /**
+     * @brief Retorna o buffer que guarda o texto da base.
+     *
+     * O buffer deve ser preenchido antes de adicionar as estações e não pode ser redimensionado depois,
+     * pois os endereços apontam para ele.
+     *
+     * @return Referência para o buffer.
+     */
+    std::vector<char> &text()
+    {
+        return _text;
+    }
+
+    /**
+     * @brief Adiciona uma estação ativa.
+     * @param x Coordenada X da estação.
+     * @param y Coordenada Y da estação.
+     * @param address Endereço da estação, com os textos apontando para text().
+     * @return O índice da nova estação.
+     */
+    stationidx_t add(double x, double y, const AddressInfo &address)
+    {
+        stationidx_t idx = static_cast<stationidx_t>(_points.size());
+        _points.push_back(Point(x, y, idx));
+        _addresses.push_back(address);
+        return idx;
+    }
+
+    /**
+     * @brief Retorna o ponto de uma estação.
+     * @param idx Índice da estação.
+     * @return Referência para o ponto.
+     */
+    Point &point(stationidx_t idx)
+    {
+        return _points[idx];
+    }
+
+    /**
+     * @brief Retorna o endereço de uma estação.
+     * @param idx Índice da estação.
+     * @return Referência para o endereço.
+     */
+    AddressInfo &address(stationidx_t idx)
+    {
+        return _addresses[idx];
+    }
+
+    /**
+     * @brief Retorna o número de estações armazenadas.
+     * @return O número de estações.
+     */
+    size_t size() const
+    {
+        return _points.size();
+    }
+};
+
+#endif // STATIONARENA_H
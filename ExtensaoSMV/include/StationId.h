@@ -0,0 +1,128 @@
+#ifndef STATIONID_H
+#define STATIONID_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @file StationId.h
+ * @brief Codificação dos identificadores das estações (idend) em inteiros de 64 bits.
+ *
+ * Um identificador como 01668501159A é formado por dígitos e, opcionalmente, uma letra final. Ele é guardado
+ * em um stationid_t com os dígitos como número (bits 12 a 61), a quantidade de dígitos, que preserva os zeros
+ * à esquerda (bits 8 a 11), e a letra (bits 0 a 7, ou 0 se não houver). A tabela hash e os endereços usam
+ * apenas o valor codificado; as mensagens dos eventos imprimem o texto lido do próprio evento.
+ *
+ * Identificadores fora desse formato não são descartados: o texto vai para uma tabela à parte, e o valor
+ * codificado é a posição nela com o bit 63 (ESCAPEDSTATIONID) ligado, que nunca é usado pela codificação
+ * compacta, cujos 15 dígitos ocupam no máximo até o bit 61.
+ */
+
+// Identificador de uma estação codificado
+using stationid_t = uint64_t;
+
+#define INVALIDSTATIONID UINT64_MAX // Resultado da codificação de um texto fora do formato
+#define MAXSTATIONIDDIGITS 15       // Maior quantidade de dígitos que cabe nos 50 bits reservados
+#define ESCAPEDSTATIONID (UINT64_C(1) << 63) // Marca os identificadores guardados na tabela de textos
+
+/**
+ * @brief Codifica o identificador contido em [inicio, fim).
+ * @param inicio Primeiro caractere do identificador.
+ * @param fim Posição logo após o último caractere.
+ * @return O identificador codificado, ou INVALIDSTATIONID se o texto não tiver de 1 a 15 dígitos seguidos de no máximo uma letra.
+ */
+inline stationid_t encodeStationId(const char *inicio, const char *fim)
+{
+    uint64_t digitos = 0;
+    int numDigitos = 0;
+    const char *c = inicio;
+    while (c < fim && *c >= '0' && *c <= '9')
+    {
+        if (++numDigitos > MAXSTATIONIDDIGITS)
+        {
+            return INVALIDSTATIONID;
+        }
+        digitos = digitos * 10 + (*c - '0');
+        c++;
+    }
+
+    uint64_t letra = 0;
+    if (c < fim && ((*c >= 'A' && *c <= 'Z') || (*c >= 'a' && *c <= 'z')))
+    {
+        letra = static_cast<unsigned char>(*c);
+        c++;
+    }
+
+    if (numDigitos == 0 || c != fim)
+    {
+        return INVALIDSTATIONID;
+    }
+    return (digitos << 12) | (static_cast<uint64_t>(numDigitos) << 8) | letra;
+}
+
+/**
+ * @brief Codifica um identificador terminado por '\0'.
+ * @param texto O identificador.
+ * @return O identificador codificado, ou INVALIDSTATIONID se o texto estiver fora do formato.
+ */
+inline stationid_t encodeStationId(const char *texto)
+{
+    return encodeStationId(texto, texto + std::strlen(texto));
+}
+
+/**
+ * @brief Tabela dos identificadores fora do formato compacto, do texto para o valor codificado. Os bits abaixo de
+ * ESCAPEDSTATIONID são a ordem em que o identificador entrou na tabela.
+ */
+inline std::unordered_map<std::string, stationid_t> &escapedStationIndex()
+{
+    static std::unordered_map<std::string, stationid_t> indice;
+    return indice;
+}
+
+/**
+ * @brief Codifica um identificador da base, guardando-o na tabela de textos se estiver fora do formato compacto.
+ * @param inicio Primeiro caractere do identificador.
+ * @param fim Posição logo após o último caractere.
+ * @return O identificador codificado, nunca INVALIDSTATIONID.
+ */
+inline stationid_t registerStationId(const char *inicio, const char *fim)
+{
+    stationid_t id = encodeStationId(inicio, fim);
+    if (id != INVALIDSTATIONID)
+    {
+        return id;
+    }
+
+    std::string texto(inicio, fim);
+    std::unordered_map<std::string, stationid_t>::iterator it = escapedStationIndex().find(texto);
+    if (it != escapedStationIndex().end())
+    {
+        return it->second;
+    }
+    id = ESCAPEDSTATIONID | escapedStationIndex().size();
+    escapedStationIndex()[texto] = id;
+    return id;
+}
+
+/**
+ * @brief Codifica o identificador de um evento, procurando-o na tabela de textos se estiver fora do formato compacto.
+ * @param inicio Primeiro caractere do identificador.
+ * @param fim Posição logo após o último caractere.
+ * @return O identificador codificado, ou INVALIDSTATIONID se ele não faz parte da base.
+ */
+inline stationid_t findStationId(const char *inicio, const char *fim)
+{
+    stationid_t id = encodeStationId(inicio, fim);
+    if (id != INVALIDSTATIONID || escapedStationIndex().empty())
+    {
+        return id;
+    }
+
+    std::unordered_map<std::string, stationid_t>::iterator it = escapedStationIndex().find(std::string(inicio, fim));
+    return it != escapedStationIndex().end() ? it->second : INVALIDSTATIONID;
+}
+
+#endif // STATIONID_H
@@ -0,0 +1,130 @@
+#include "DistanceKernel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DISTANCE_KERNEL_X86
+#endif
+
+static void squaredDistancesScalar(const double *xs, const double *ys, int n, double px, double py, double *out)
+{
+    for (int i = 0; i < n; i++)
+    {
+        double dx = xs[i] - px;
+        double dy = ys[i] - py;
+        out[i] = dx * dx + dy * dy;
+    }
+}
+
+#ifdef DISTANCE_KERNEL_X86
+__attribute__((target("sse2"))) static void squaredDistancesSSE2(const double *xs, const double *ys, int n, double px, double py, double *out)
+{
+    __m128d vpx = _mm_set1_pd(px);
+    __m128d vpy = _mm_set1_pd(py);
+    int i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i), vpx);
+        __m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i), vpy);
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)));
+    }
+    squaredDistancesScalar(xs + i, ys + i, n - i, px, py, out + i);
+}
+
+__attribute__((target("avx2"))) static void squaredDistancesAVX2(const double *xs, const double *ys, int n, double px, double py, double *out)
+{
+    __m256d vpx = _mm256_set1_pd(px);
+    __m256d vpy = _mm256_set1_pd(py);
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), vpx);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), vpy);
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+    }
+    squaredDistancesScalar(xs + i, ys + i, n - i, px, py, out + i);
+}
+#endif
+
+/**
+ * @brief Verifica se o processador suporta uma implementação.
+ */
+static bool supported(DistanceKernel kernel)
+{
+#ifdef DISTANCE_KERNEL_X86
+    __builtin_cpu_init(); // Necessário porque a seleção inicial é feita durante a inicialização estática
+#endif
+    switch (kernel)
+    {
+    case SCALAR_KERNEL:
+        return true;
+#ifdef DISTANCE_KERNEL_X86
+    case SSE2_KERNEL:
+        return __builtin_cpu_supports("sse2");
+    case AVX2_KERNEL:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+DistanceKernel bestDistanceKernel()
+{
+    if (supported(AVX2_KERNEL))
+    {
+        return AVX2_KERNEL;
+    }
+    if (supported(SSE2_KERNEL))
+    {
+        return SSE2_KERNEL;
+    }
+    return SCALAR_KERNEL;
+}
+
+static DistanceKernel selectedKernel = bestDistanceKernel(); /**< Implementação usada por squaredDistances */
+
+bool setDistanceKernel(DistanceKernel kernel)
+{
+    if (!supported(kernel))
+    {
+        return false;
+    }
+    selectedKernel = kernel;
+    return true;
+}
+
+DistanceKernel currentDistanceKernel()
+{
+    return selectedKernel;
+}
+
+const char *distanceKernelName(DistanceKernel kernel)
+{
+    switch (kernel)
+    {
+    case SSE2_KERNEL:
+        return "sse2";
+    case AVX2_KERNEL:
+        return "avx2";
+    default:
+        return "escalar";
+    }
+}
+
+void squaredDistances(const double *xs, const double *ys, int n, double px, double py, double *out)
+{
+    switch (selectedKernel)
+    {
+#ifdef DISTANCE_KERNEL_X86
+    case AVX2_KERNEL:
+        squaredDistancesAVX2(xs, ys, n, px, py, out);
+        break;
+    case SSE2_KERNEL:
+        squaredDistancesSSE2(xs, ys, n, px, py, out);
+        break;
+#endif
+    default:
+        squaredDistancesScalar(xs, ys, n, px, py, out);
+        break;
+    }
+}
@@ -92,12 +92,26 @@ int PriorityQueue<T>::leftChild(int index) { return (2 * index + 1); }
 template <typename T>
 int PriorityQueue<T>::rightChild(int index) { return (2 * index + 2); }
 
+template <typename T>
+void PriorityQueue<T>::grow()
+{
+    int capacity = _capacity > 0 ? 2 * _capacity : 1;
+    T *heap = new T[capacity];
+    for (int i = 0; i < _size; i++)
+    {
+        heap[i] = _heap[i];
+    }
+    delete[] _heap;
+    _heap = heap;
+    _capacity = capacity;
+}
+
 template <typename T>
 void PriorityQueue<T>::push(T data)
 {
     if (_size == _capacity)
     {
-        throw std::out_of_range("Priority Queue is full.");
+        grow();
     }
     _heap[_size] = data;
     heapifyUp(_size);
@@ -113,7 +127,7 @@ void PriorityQueue<T>::forcePush(T data)
 }
 
 template <typename T>
-T PriorityQueue<T>::top()
+const T &PriorityQueue<T>::top()
 {
     if (_size <= 0)
     {
@@ -145,6 +159,12 @@ int PriorityQueue<T>::size()
     return _size;
 }
 
+template <typename T>
+void PriorityQueue<T>::clear()
+{
+    _size = 0;
+}
+
 template <typename T>
 void PriorityQueue<T>::toggleMode()
 {
@@ -157,4 +177,5 @@ void PriorityQueue<T>::toggleMode()
 
 // Especifica a implementação do template para o tipo utilizado nos algoritmos.
 template class PriorityQueue<Pair<double, Point>>;
-template class PriorityQueue<Pair<double, long>>;
\ No newline at end of file
+template class PriorityQueue<Pair<double, long>>;
+template class PriorityQueue<Pair<double, int>>;
\ No newline at end of file
@@ -1,18 +1,56 @@
 // QuadNode.cpp
 #include "QuadNode.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
 
-QuadNode::QuadNode(Rectangle boundary, quadnodekey_t key, quadnodeaddr_t ne, quadnodeaddr_t nw, quadnodeaddr_t se, quadnodeaddr_t sw, Point *ponto) : _boundary(boundary), key(INVALIDKEY), ne(ne), nw(nw), se(se), sw(sw), _point(ponto)
+/**
+ * @brief Converte um limite inferior para float sem ultrapassar o valor original.
+ */
+static float floorToFloat(double v)
+{
+    float f = static_cast<float>(v);
+    return (f > v) ? std::nextafter(f, -INFINITY) : f;
+}
+
+/**
+ * @brief Converte um limite superior para float sem ficar abaixo do valor original.
+ */
+static float ceilToFloat(double v)
+{
+    float f = static_cast<float>(v);
+    return (f < v) ? std::nextafter(f, INFINITY) : f;
+}
+
+QuadNode::QuadNode(const Rectangle &boundary)
+    : _x(0), _y(0),
+      _lbx(floorToFloat(boundary.getLB().getX())), _lby(floorToFloat(boundary.getLB().getY())),
+      _rtx(ceilToFloat(boundary.getRT().getX())), _rty(ceilToFloat(boundary.getRT().getY())),
+      ne(INVALIDADDR), nw(INVALIDADDR), se(INVALIDADDR), sw(INVALIDADDR),
+      _activeCount(0), _pointCount(0), _bucket(INVALIDBUCKET), _bucketCount(0), _hasPoint(false), _active(false)
 {
 }
 
 void QuadNode::reset()
 {
-    key = INVALIDKEY;
     ne = nw = se = sw = INVALIDADDR;
-    _point = nullptr;
+    _activeCount = 0;
+    _pointCount = 0;
+    _bucket = INVALIDBUCKET;
+    _bucketCount = 0;
+    _hasPoint = false;
+    _active = false;
 }
 
-void QuadNodeManager::initialize(long capacity)
+double QuadNode::distanceSquared(const Point &p) const
+{
+    double dx = _x - p.getX();
+    double dy = _y - p.getY();
+    return dx * dx + dy * dy;
+}
+
+void QuadNodeManager::initialize(long capacity, int bucketSize)
 {
     smv = &SMV::getInstance();
 
@@ -24,7 +62,12 @@ void QuadNodeManager::initialize(long capacity)
         throw QuadNodeManagerException("Falha ao alocar memória para nodes usando SMV.");
     }
 
-    if (static_cast<int>(capacity * sizeof(QuadNode)) > bytesallocated)
+    // Um balde não pode cruzar páginas do SMV
+    _bucketSize = std::max(0, std::min(bucketSize, std::min(MAXBUCKETSIZE, static_cast<int>(PAGESIZE / (2 * sizeof(double))))));
+    _numBuckets = 0;
+
+    // Com baldes, o espaço ocupado depende da distribuição dos pontos e só é verificado durante a construção
+    if (_bucketSize == 0 && static_cast<int>(capacity * sizeof(QuadNode)) > bytesallocated)
     {
         throw QuadNodeManagerException("SMV não forneceu memória suficiente.");
     }
@@ -32,10 +75,15 @@ void QuadNodeManager::initialize(long capacity)
     _capacity = bytesallocated / sizeof(QuadNode);
     std::cout << "QuadNodeManager initialized with capacity: " << _capacity << std::endl;
     _size = 0;
+    firstAvail = INVALIDADDR;
+    _numFree = 0;
 
+    // Os índices das estações só são usados para montar as respostas e ficam fora da memória do SMV
+    stations = new stationidx_t[_capacity];
     for (size_t i = 0; i < _capacity; ++i)
     {
         new (&nodes[i]) QuadNode();
+        stations[i] = INVALIDSTATION;
     }
     std::cout << "QuadNodeManager inicializado." << std::endl;
 }
@@ -49,25 +97,43 @@ void QuadNodeManager::destroy()
             nodes[i].~QuadNode();
         }
 
+        delete[] stations;
+        stations = nullptr;
+        bucketStations.clear();
+        bucketActive.clear();
+        freeBuckets.clear();
+        _numBuckets = 0;
         nodes = nullptr;
         _size = 0;
+        firstAvail = INVALIDADDR;
+        _numFree = 0;
         _capacity = 0;
     }
 }
 
 quadnodeaddr_t QuadNodeManager::createNode(const QuadNode &pn)
 {
-    if (_size >= _capacity)
-    {
-        throw QuadNodeManagerException("Capacidade máxima de nós atingida.");
-    }
-
     if (nodes == nullptr)
     {
         std::cerr << "QuadNodeManager: Memória para nodes não alocada." << std::endl;
         return INVALIDADDR;
     }
 
+    if (firstAvail != INVALIDADDR)
+    {
+        quadnodeaddr_t addr = firstAvail;
+        firstAvail = nodes[addr].ne;
+        _numFree--;
+        nodes[addr] = pn;
+        return addr;
+    }
+
+    // As páginas finais podem estar ocupadas por baldes
+    if (_size >= _capacity - bucketPages(_numBuckets) * (PAGESIZE / sizeof(QuadNode)))
+    {
+        throw QuadNodeManagerException("Capacidade máxima de nós atingida.");
+    }
+
     quadnodeaddr_t addr = _size++;
     nodes[addr] = pn;
 
@@ -81,19 +147,178 @@ void QuadNodeManager::deleteNode(quadnodeaddr_t addr)
         std::cerr << "QuadNodeManager: Endereço fora do intervalo." << std::endl;
         return;
     }
+    if (nodes[addr]._bucket != INVALIDBUCKET)
+    {
+        freeBuckets.push_back(nodes[addr]._bucket);
+    }
     nodes[addr].reset();
+    stations[addr] = INVALIDSTATION;
+    nodes[addr].ne = firstAvail;
+    firstAvail = addr;
+    _numFree++;
+}
+
+size_t QuadNodeManager::bucketPages(int32_t numBuckets) const
+{
+    if (_bucketSize == 0)
+    {
+        return 0;
+    }
+    size_t perPage = PAGESIZE / (2 * _bucketSize * sizeof(double));
+    return (numBuckets + perPage - 1) / perPage;
+}
+
+double *QuadNodeManager::bucketCoords(int32_t bucket) const
+{
+    size_t perPage = PAGESIZE / (2 * _bucketSize * sizeof(double));
+    size_t numPages = _capacity * sizeof(QuadNode) / PAGESIZE;
+    char *page = reinterpret_cast<char *>(nodes) + (numPages - 1 - bucket / perPage) * PAGESIZE;
+    return reinterpret_cast<double *>(page) + (bucket % perPage) * 2 * _bucketSize;
+}
+
+int32_t QuadNodeManager::createBucket()
+{
+    if (!freeBuckets.empty())
+    {
+        int32_t bucket = freeBuckets.back();
+        freeBuckets.pop_back();
+        return bucket;
+    }
+
+    size_t nodePages = (_size * sizeof(QuadNode) + PAGESIZE - 1) / PAGESIZE;
+    if (nodePages + bucketPages(_numBuckets + 1) > _capacity * sizeof(QuadNode) / PAGESIZE)
+    {
+        throw QuadNodeManagerException("Memória do SMV esgotada: não há página livre para um novo balde.");
+    }
+
+    size_t size = static_cast<size_t>(_numBuckets + 1) * _bucketSize;
+    bucketStations.resize(size, INVALIDSTATION);
+    bucketActive.resize(size);
+    return _numBuckets++;
+}
+
+void QuadNodeManager::addToBucket(quadnodeaddr_t addr, const Point &p)
+{
+    QuadNode &node = nodes[addr];
+    if (node._bucket == INVALIDBUCKET)
+    {
+        node._bucket = createBucket();
+    }
+
+    int slot = node._bucketCount++;
+    double *coords = bucketCoords(node._bucket);
+    coords[slot] = p.getX();
+    coords[_bucketSize + slot] = p.getY();
+    bucketStations[static_cast<size_t>(node._bucket) * _bucketSize + slot] = p.getId();
+    bucketActive[static_cast<size_t>(node._bucket) * _bucketSize + slot] = p.isActive();
+}
+
+void QuadNodeManager::takeBucket(quadnodeaddr_t addr, std::vector<Point> &out)
+{
+    QuadNode &node = nodes[addr];
+    if (node._bucket == INVALIDBUCKET)
+    {
+        return;
+    }
+
+    for (int slot = 0; slot < node._bucketCount; slot++)
+    {
+        out.push_back(getBucketPoint(node, slot));
+    }
+    freeBuckets.push_back(node._bucket);
+    node._bucket = INVALIDBUCKET;
+    node._bucketCount = 0;
+}
+
+void QuadNodeManager::removeFromBucket(quadnodeaddr_t addr, int slot)
+{
+    QuadNode &node = nodes[addr];
+    int32_t bucket = node._bucket;
+    int last = --node._bucketCount;
+    bool empty = last == 0;
+
+    double *coords = bucketCoords(bucket);
+    coords[slot] = coords[last];
+    coords[_bucketSize + slot] = coords[_bucketSize + last];
+    size_t base = static_cast<size_t>(bucket) * _bucketSize;
+    bucketStations[base + slot] = bucketStations[base + last];
+    bucketActive[base + slot] = bucketActive[base + last];
+    if (empty)
+    {
+        freeBuckets.push_back(bucket);
+        nodes[addr]._bucket = INVALIDBUCKET;
+    }
 }
 
-QuadNode QuadNodeManager::getNode(quadnodeaddr_t addr) const
+int QuadNodeManager::bucketSlot(quadnodeaddr_t addr, const Point &p) const
 {
+    const QuadNode &node = getNode(addr);
+    if (node._bucketCount == 0)
+    {
+        return -1;
+    }
+
+    const double *coords = bucketCoords(node._bucket);
+    const stationidx_t *ids = &bucketStations[static_cast<size_t>(node._bucket) * _bucketSize];
+    for (int slot = 0; slot < node._bucketCount; slot++)
+    {
+        if (ids[slot] == p.getId() && coords[slot] == p.getX() && coords[_bucketSize + slot] == p.getY())
+        {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+Point QuadNodeManager::getBucketPoint(const QuadNode &leaf, int slot) const
+{
+    const double *coords = bucketCoords(leaf._bucket);
+    size_t index = static_cast<size_t>(leaf._bucket) * _bucketSize + slot;
+    return Point(coords[slot], coords[_bucketSize + slot], bucketStations[index], bucketActive[index]);
+}
+
+const QuadNode &QuadNodeManager::getNode(quadnodeaddr_t addr) const
+{
+    static const QuadNode emptyNode; // Retornado para endereços inválidos, nunca é modificado
     if (addr < 0 || static_cast<size_t>(addr) >= _size)
     {
         std::cerr << "QuadNodeManager: Endereço fora do intervalo." << std::endl;
-        return QuadNode();
+        return emptyNode;
     }
     return nodes[addr];
 }
 
+Point QuadNodeManager::getPoint(quadnodeaddr_t addr) const
+{
+    if (addr < 0 || static_cast<size_t>(addr) >= _size)
+    {
+        std::cerr << "QuadNodeManager: Endereço fora do intervalo." << std::endl;
+        return Point();
+    }
+    const QuadNode &node = nodes[addr];
+    return Point(node._x, node._y, stations[addr], node._active);
+}
+
+void QuadNodeManager::setPoint(quadnodeaddr_t addr, const Point &p)
+{
+    if (addr < 0 || static_cast<size_t>(addr) >= _size)
+    {
+        std::cerr << "QuadNodeManager: Endereço fora do intervalo." << std::endl;
+        return;
+    }
+    stations[addr] = p.getId();
+    nodes[addr]._x = p.getX();
+    nodes[addr]._y = p.getY();
+    nodes[addr]._hasPoint = true;
+    nodes[addr]._active = p.isActive();
+}
+
+bool QuadNodeManager::holds(quadnodeaddr_t addr, const Point &p) const
+{
+    const QuadNode &node = getNode(addr);
+    return node._hasPoint && stations[addr] == p.getId() && node._x == p.getX() && node._y == p.getY();
+}
+
 void QuadNodeManager::putNode(quadnodeaddr_t addr, QuadNode &pn)
 {
     // Verificar se o endereço está dentro do intervalo válido
@@ -112,52 +337,179 @@ void QuadNodeManager::putNode(quadnodeaddr_t addr, QuadNode &pn)
     nodes[addr] = pn;
 }
 
-quadnodeaddr_t QuadNodeManager::localize(quadnodeaddr_t addr, const Point &p)
+int QuadNodeManager::quadrant(quadnodeaddr_t addr, const Point &p) const
+{
+    const QuadNode &node = nodes[addr];
+
+    // Os quadrantes são fechados e compartilham as bordas: a ordem dos testes decide os empates
+    bool east = p.getX() >= node._x;
+    bool west = p.getX() <= node._x;
+    bool north = p.getY() >= node._y;
+    bool south = p.getY() <= node._y;
+
+    if (east && north)
+    {
+        return NE;
+    }
+    else if (west && north)
+    {
+        return NW;
+    }
+    else if (west && south)
+    {
+        return SW;
+    }
+    return SE;
+}
+
+Rectangle QuadNodeManager::quadrantBoundary(quadnodeaddr_t addr, int q) const
 {
-    QuadNode nx = getNode(addr);
-    Rectangle _boundary = nx._boundary;
-    Point *_point = nx._point;
-    Point mid(_point->getX(), _point->getY());
+    const QuadNode &node = nodes[addr];
 
-    Rectangle neRet = Rectangle(mid, Point(_boundary.getRT().getX(), _boundary.getRT().getY()));
-    Rectangle nwRet = Rectangle(Point(_boundary.getLB().getX(), mid.getY()), Point(mid.getX(), _boundary.getRT().getY()));
-    Rectangle swRet = Rectangle(Point(_boundary.getLB().getX(), _boundary.getLB().getY()), mid);
-    Rectangle seRet = Rectangle(Point(mid.getX(), _boundary.getLB().getY()), Point(_boundary.getRT().getX(), mid.getY()));
+    switch (q)
+    {
+    case NE:
+        return Rectangle(Point(node._x, node._y), Point(node._rtx, node._rty));
+    case NW:
+        return Rectangle(Point(node._lbx, node._y), Point(node._x, node._rty));
+    case SW:
+        return Rectangle(Point(node._lbx, node._lby), Point(node._x, node._y));
+    default:
+        return Rectangle(Point(node._x, node._lby), Point(node._rtx, node._y));
+    }
+}
+
+void QuadNodeManager::permute(const std::vector<quadnodeaddr_t> &newAddr)
+{
+    // Os nós são copiados para fora do vetor e reescritos em ordem crescente de endereço,
+    // de modo que tanto a leitura quanto a escrita percorrem as páginas do SMV uma única vez
+    std::vector<stationidx_t> oldStations(stations, stations + _size);
+    std::vector<quadnodeaddr_t> oldAddr(_size);
+    for (size_t i = 0; i < _size; i++)
+    {
+        oldAddr[newAddr[i]] = i;
+    }
+
+    // Como em initialize, a cópia dos nós precisa de memória alinhada à linha de cache, que std::vector não
+    // garante em C++11
+    void *mem = nullptr;
+    if (posix_memalign(&mem, alignof(QuadNode), _size * sizeof(QuadNode)) != 0)
+    {
+        throw QuadNodeManagerException("Falha ao alocar a cópia dos nós para a renumeração.");
+    }
+    QuadNode *oldNodes = static_cast<QuadNode *>(mem);
+    for (size_t i = 0; i < _size; i++)
+    {
+        new (&oldNodes[i]) QuadNode(nodes[i]);
+    }
 
-    if (_boundary.contains(p))
+    for (size_t i = 0; i < _size; i++)
     {
-        if (neRet.contains(p))
+        QuadNode node = oldNodes[oldAddr[i]];
+        quadnodeaddr_t *children[4] = {&node.ne, &node.nw, &node.sw, &node.se};
+        for (quadnodeaddr_t *child : children)
         {
-            if (nodes[addr].ne == INVALIDADDR)
+            if (*child != INVALIDADDR)
             {
-                nodes[addr].ne = createNode(QuadNode(neRet));
+                *child = newAddr[*child];
             }
-            return nodes[addr].ne;
         }
-        else if (nwRet.contains(p))
+        nodes[i] = node;
+        stations[i] = oldStations[oldAddr[i]];
+    }
+    free(oldNodes);
+
+    // Os baldes também são copiados para fora e regravados na ordem das folhas, de modo que folhas vizinhas no
+    // vetor de nós tenham seus pontos nas mesmas páginas
+    size_t bucketBytes = 2 * _bucketSize * sizeof(double);
+    std::vector<double> oldCoords(static_cast<size_t>(_numBuckets) * 2 * _bucketSize);
+    for (int32_t b = 0; b < _numBuckets; b++)
+    {
+        std::memcpy(&oldCoords[static_cast<size_t>(b) * 2 * _bucketSize], bucketCoords(b), bucketBytes);
+    }
+    std::vector<stationidx_t> oldBucketStations;
+    std::vector<uint8_t> oldActive;
+    oldBucketStations.swap(bucketStations);
+    oldActive.swap(bucketActive);
+    freeBuckets.clear();
+    _numBuckets = 0;
+
+    for (size_t i = 0; i < _size; i++)
+    {
+        if (nodes[i]._bucket == INVALIDBUCKET)
         {
-            if (nodes[addr].nw == INVALIDADDR)
-            {
-                nodes[addr].nw = createNode(QuadNode(nwRet));
-            }
-            return nodes[addr].nw;
+            continue;
+        }
+        size_t from = static_cast<size_t>(nodes[i]._bucket) * _bucketSize;
+        int32_t bucket = createBucket();
+        nodes[i]._bucket = bucket;
+        std::memcpy(bucketCoords(bucket), &oldCoords[2 * from], bucketBytes);
+        std::copy(oldBucketStations.begin() + from, oldBucketStations.begin() + from + _bucketSize, bucketStations.begin() + static_cast<size_t>(bucket) * _bucketSize);
+        std::copy(oldActive.begin() + from, oldActive.begin() + from + _bucketSize, bucketActive.begin() + static_cast<size_t>(bucket) * _bucketSize);
+    }
+}
+
+void QuadNodeManager::truncate(size_t size)
+{
+    for (size_t i = size; i < _size; i++)
+    {
+        nodes[i] = QuadNode();
+        stations[i] = INVALIDSTATION;
+    }
+    _size = size;
+    firstAvail = INVALIDADDR;
+    _numFree = 0;
+}
+
+size_t QuadNodeManager::size() const
+{
+    return _size - _numFree;
+}
+
+quadnodeaddr_t QuadNodeManager::localize(quadnodeaddr_t addr, const Point &p)
+{
+    switch (quadrant(addr, p))
+    {
+    case NE:
+        if (nodes[addr].ne == INVALIDADDR)
+        {
+            nodes[addr].ne = createNode(QuadNode(quadrantBoundary(addr, NE)));
         }
-        else if (swRet.contains(p))
+        return nodes[addr].ne;
+    case NW:
+        if (nodes[addr].nw == INVALIDADDR)
         {
-            if (nodes[addr].sw == INVALIDADDR)
-            {
-                nodes[addr].sw = createNode(QuadNode(swRet));
-            }
-            return nodes[addr].sw;
+            nodes[addr].nw = createNode(QuadNode(quadrantBoundary(addr, NW)));
         }
-        else if (seRet.contains(p))
+        return nodes[addr].nw;
+    case SW:
+        if (nodes[addr].sw == INVALIDADDR)
         {
-            if (nodes[addr].se == INVALIDADDR)
-            {
-                nodes[addr].se = createNode(QuadNode(seRet));
-            }
-            return nodes[addr].se;
+            nodes[addr].sw = createNode(QuadNode(quadrantBoundary(addr, SW)));
+        }
+        return nodes[addr].sw;
+    case SE:
+        if (nodes[addr].se == INVALIDADDR)
+        {
+            nodes[addr].se = createNode(QuadNode(quadrantBoundary(addr, SE)));
         }
+        return nodes[addr].se;
+    }
+    return INVALIDADDR;
+}
+
+quadnodeaddr_t QuadNodeManager::child(quadnodeaddr_t addr, const Point &p) const
+{
+    switch (quadrant(addr, p))
+    {
+    case NE:
+        return nodes[addr].ne;
+    case NW:
+        return nodes[addr].nw;
+    case SW:
+        return nodes[addr].sw;
+    case SE:
+        return nodes[addr].se;
     }
     return INVALIDADDR;
 }
@@ -1,14 +1,14 @@
 #include "QuadTree.h"
+#include "DistanceKernel.h"
 #include <algorithm>
 #include <iostream>
 
-QuadTree::QuadTree(long numNodes, Rectangle boundary)
-    : _root(0), _nodeManager()
+QuadTree::QuadTree(long numNodes, Rectangle boundary, int bucketSize)
+    : _root(0), _nodeManager(), _boundary(boundary)
 {
-    _nodeManager.initialize(numNodes);
+    _nodeManager.initialize(numNodes, bucketSize);
 
-    QuadNode root_node(boundary, 0, INVALIDADDR, INVALIDADDR, INVALIDADDR, INVALIDADDR, nullptr);
-    _root = _nodeManager.createNode(root_node); // Use createNode instead of putNode
+    _root = _nodeManager.createNode(QuadNode(boundary));
 }
 
 QuadTree::~QuadTree()
@@ -22,18 +22,27 @@ quadnodeaddr_t QuadTree::search(Point &p)
 
     while (current != INVALIDADDR)
     {
-        QuadNode currentNode = _nodeManager.getNode(current);
+        const QuadNode &currentNode = _nodeManager.getNode(current);
 
-        if (currentNode._point == nullptr)
+        if (!currentNode._hasPoint)
         {
+            // Folha: o ponto só pode estar no balde
+            for (int slot = 0; slot < currentNode._bucketCount; slot++)
+            {
+                Point q = _nodeManager.getBucketPoint(currentNode, slot);
+                if (q.getX() == p.getX() && q.getY() == p.getY())
+                {
+                    return current;
+                }
+            }
             break;
         }
-        if (*(currentNode._point) == p)
+        if (currentNode._x == p.getX() && currentNode._y == p.getY())
         {
             return current;
         }
 
-        current = _nodeManager.localize(current, p);
+        current = _nodeManager.child(current, p);
     }
 
     return INVALIDADDR;
@@ -41,24 +50,56 @@ quadnodeaddr_t QuadTree::search(Point &p)
 
 quadnodeaddr_t QuadTree::insert(Point &p)
 {
+    // Os quadrantes dos filhos estão sempre contidos no pai, então basta verificar a raiz
+    if (!_boundary.contains(p))
+    {
+        return INVALIDADDR;
+    }
+
     quadnodeaddr_t current = _root;
 
     while (true)
     {
-        QuadNode currentNode = _nodeManager.getNode(current);
+        const QuadNode &currentNode = _nodeManager.getNode(current);
 
-        if (!currentNode._boundary.contains(p))
+        if (!currentNode._hasPoint)
         {
-            return INVALIDADDR;
-        }
-        if (currentNode._point == nullptr)
-        {
-            currentNode._point = &p;
-            _nodeManager.putNode(current, currentNode);
-            return current;
+            _nodeManager.nodes[current]._pointCount++;
+            if (p.isActive())
+            {
+                _nodeManager.nodes[current]._activeCount++;
+            }
+            if (currentNode._bucketCount < _nodeManager._bucketSize)
+            {
+                _nodeManager.addToBucket(current, p);
+                return current;
+            }
+            if (currentNode._bucketCount == 0)
+            {
+                _nodeManager.setPoint(current, p); // Sem baldes, cada nó guarda um ponto
+                return current;
+            }
+
+            // Balde cheio: a folha é reconstruída com seus pontos e o novo, e passa a ter ponto e filhos
+            std::vector<Point> points;
+            _nodeManager.takeBucket(current, points);
+            points.push_back(p);
+            std::vector<Point *> refs;
+            for (Point &point : points)
+            {
+                refs.push_back(&point);
+            }
+            build(current, refs.begin(), refs.end());
+            return search(p);
         }
         else
         {
+            // O ponto será inserido nesta subárvore
+            _nodeManager.nodes[current]._pointCount++;
+            if (p.isActive())
+            {
+                _nodeManager.nodes[current]._activeCount++;
+            }
             current = _nodeManager.localize(current, p);
             if (current == INVALIDADDR) // Check if localization was successful
             {
@@ -68,141 +109,573 @@ quadnodeaddr_t QuadTree::insert(Point &p)
     }
 }
 
-void QuadTree::destroy()
+void QuadTree::build(std::vector<Point *> &points)
 {
-    _nodeManager.destroy();
+    if (_nodeManager.nodes[_root]._hasPoint || _nodeManager.nodes[_root]._bucketCount > 0)
+    {
+        for (Point *p : points)
+        {
+            insert(*p);
+        }
+        return;
+    }
+
+    std::vector<Point *>::iterator end = std::partition(points.begin(), points.end(), [this](const Point *p)
+                                                        { return _boundary.contains(*p); });
+    if (end != points.begin())
+    {
+        build(_root, points.begin(), end);
+    }
 }
 
-double heuristic(const Point &p, const Rectangle &box)
+void QuadTree::build(quadnodeaddr_t addr, std::vector<Point *>::iterator begin, std::vector<Point *>::iterator end)
+{
+    _nodeManager.nodes[addr]._pointCount = end - begin;
+    _nodeManager.nodes[addr]._activeCount = std::count_if(begin, end, [](const Point *p)
+                                                          { return p->isActive(); });
+
+    // Poucos pontos cabem no balde de uma folha
+    if (end - begin <= _nodeManager._bucketSize)
+    {
+        for (std::vector<Point *>::iterator it = begin; it != end; ++it)
+        {
+            _nodeManager.addToBucket(addr, **it);
+        }
+        return;
+    }
+
+    // O ponto mediano vai para o início do intervalo e passa a dividir o nó
+    std::vector<Point *>::iterator median = begin + (end - begin) / 2;
+    std::nth_element(begin, median, end, [](const Point *a, const Point *b)
+                     { return a->getX() < b->getX() || (a->getX() == b->getX() && a->getY() < b->getY()); });
+    std::iter_swap(begin, median);
+    _nodeManager.setPoint(addr, **begin);
+
+    // Agrupa os demais pontos por quadrante, na ordem NE, NW, SW, SE, com os mesmos desempates de
+    // QuadNodeManager::quadrant: ao norte (y >= cy) ficam NE (x >= cx) e NW; ao sul, SW (x <= cx) e SE
+    double cx = (*begin)->getX();
+    double cy = (*begin)->getY();
+    std::vector<Point *>::iterator groups[5];
+    groups[0] = begin + 1;
+    groups[4] = end;
+    groups[2] = std::partition(groups[0], groups[4], [cy](const Point *p)
+                               { return p->getY() >= cy; });
+    groups[1] = std::partition(groups[0], groups[2], [cx](const Point *p)
+                               { return p->getX() >= cx; });
+    groups[3] = std::partition(groups[2], groups[4], [cx](const Point *p)
+                               { return p->getX() <= cx; });
+
+    for (int q = NE; q <= SE; q++)
+    {
+        if (groups[q] != groups[q + 1])
+        {
+            build(_nodeManager.localize(addr, **groups[q]), groups[q], groups[q + 1]);
+        }
+    }
+}
+
+void QuadTree::detach(quadnodeaddr_t addr, std::vector<Point> &out)
 {
-    double xMin = box.getLB().getX();
-    double xMax = box.getRT().getX();
-    double yMin = box.getLB().getY();
-    double yMax = box.getRT().getY();
+    QuadNode &node = _nodeManager.nodes[addr];
+    if (node._hasPoint)
+    {
+        out.push_back(_nodeManager.getPoint(addr));
+    }
+    _nodeManager.takeBucket(addr, out);
+
+    quadnodeaddr_t children[4] = {node.ne, node.nw, node.sw, node.se};
+    for (quadnodeaddr_t child : children)
+    {
+        if (child != INVALIDADDR)
+        {
+            detach(child, out);
+            _nodeManager.deleteNode(child);
+        }
+    }
+    node.reset();
+    _nodeManager.stations[addr] = INVALIDSTATION;
+}
+
+bool QuadTree::remove(Point &p)
+{
+    // Localiza o ponto, guardando o caminho desde a raiz
+    std::vector<quadnodeaddr_t> path;
+    quadnodeaddr_t current = _root;
+    int slot = -1; // Posição do ponto no balde, se ele estiver em uma folha
+    while (current != INVALIDADDR)
+    {
+        path.push_back(current);
+        if (_nodeManager.holds(current, p))
+        {
+            break;
+        }
+        if (!_nodeManager.nodes[current]._hasPoint)
+        {
+            slot = _nodeManager.bucketSlot(current, p);
+            if (slot < 0)
+            {
+                return false;
+            }
+            break;
+        }
+        current = _nodeManager.child(current, p);
+    }
+    if (current == INVALIDADDR)
+    {
+        return false;
+    }
+
+    bool active = _nodeManager.nodes[current]._active;
+    if (slot >= 0)
+    {
+        active = _nodeManager.bucketActive[static_cast<size_t>(_nodeManager.nodes[current]._bucket) * _nodeManager._bucketSize + slot];
+    }
+    for (quadnodeaddr_t addr : path)
+    {
+        _nodeManager.nodes[addr]._pointCount--;
+        _nodeManager.nodes[addr]._activeCount -= active;
+    }
+
+    if (slot >= 0)
+    {
+        _nodeManager.removeFromBucket(current, slot);
+    }
+    else
+    {
+        // O ponto divide o nó: a subárvore é reconstruída com os demais pontos
+        std::vector<Point> points;
+        detach(current, points);
+        points.erase(points.begin());
+        std::vector<Point *> refs;
+        for (Point &point : points)
+        {
+            refs.push_back(&point);
+        }
+        if (!refs.empty())
+        {
+            build(current, refs.begin(), refs.end());
+        }
+    }
+
+    // O nó mais alto do caminho cuja subárvore cabe em um balde vira uma folha, absorvendo os descendentes
+    for (quadnodeaddr_t addr : path)
+    {
+        const QuadNode &node = _nodeManager.nodes[addr];
+        if (node._hasPoint && node._pointCount <= _nodeManager._bucketSize)
+        {
+            std::vector<Point> points;
+            detach(addr, points);
+            std::vector<Point *> refs;
+            for (Point &point : points)
+            {
+                refs.push_back(&point);
+            }
+            build(addr, refs.begin(), refs.end());
+            return true;
+        }
+    }
 
-    Point center((xMin + xMax) / 2.0, (yMin + yMax) / 2.0);
-    Point bottomLeft(xMin, yMin);
-    Point bottomRight(xMax, yMin);
-    Point topLeft(xMin, yMax);
-    Point topRight(xMax, yMax);
+    // Uma folha que ficou vazia é desligada do pai e excluída
+    if (current != _root && _nodeManager.nodes[current]._pointCount == 0)
+    {
+        QuadNode &parent = _nodeManager.nodes[path[path.size() - 2]];
+        quadnodeaddr_t *children[4] = {&parent.ne, &parent.nw, &parent.sw, &parent.se};
+        for (quadnodeaddr_t *child : children)
+        {
+            if (*child == current)
+            {
+                *child = INVALIDADDR;
+            }
+        }
+        _nodeManager.deleteNode(current);
+    }
+    return true;
+}
 
-    double distCenter = p.distance(center);
-    double distBottomLeft = p.distance(bottomLeft);
-    double distBottomRight = p.distance(bottomRight);
-    double distTopLeft = p.distance(topLeft);
-    double distTopRight = p.distance(topRight);
+long QuadTree::nodeCount() const
+{
+    return _nodeManager.size();
+}
 
-    return std::min({distBottomLeft, distBottomRight, distTopLeft, distTopRight, distCenter});
+/**
+ * @brief Intercala os bits de x e y, formando a posição do ponto na curva Z.
+ */
+static uint64_t mortonKey(uint32_t x, uint32_t y)
+{
+    uint64_t key = 0;
+    for (int b = 31; b >= 0; b--)
+    {
+        key = (key << 2) | (static_cast<uint64_t>((y >> b) & 1) << 1) | ((x >> b) & 1);
+    }
+    return key;
 }
 
-void QuadTree::KNNSearch(const Point &p, int K, PriorityQueue<Pair<double, Point>> &pq)
+/**
+ * @brief Calcula a posição do ponto (x, y) na curva de Hilbert que percorre a grade de 2^32 x 2^32 células.
+ */
+static uint64_t hilbertKey(uint32_t x, uint32_t y)
 {
-    // Iterate over all nodes in memory
-    for (size_t i = 0; i < _nodeManager._size; ++i)
+    uint64_t key = 0;
+    for (uint32_t s = 1u << 31; s > 0; s >>= 1)
     {
-        try
+        uint32_t rx = (x & s) ? 1 : 0;
+        uint32_t ry = (y & s) ? 1 : 0;
+        key += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+        // Rotaciona o quadrante para que a curva continue contínua no próximo nível
+        if (ry == 0)
         {
-            QuadNode currentNode = _nodeManager.getNode(i);
+            if (rx == 1)
+            {
+                x = ~x;
+                y = ~y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return key;
+}
+
+void QuadTree::reorder(NodeOrder order)
+{
+    size_t size = _nodeManager._size;
+    if (size < 2)
+    {
+        return;
+    }
 
-            if (currentNode._point != nullptr)
+    // Lista os nós na ordem desejada
+    std::vector<quadnodeaddr_t> sequence;
+    sequence.reserve(size);
+    if (order == VEB_ORDER)
+    {
+        vebOrder(_root, height(_root), sequence);
+    }
+    else
+    {
+        // Apenas os nós alcançáveis a partir da raiz entram na curva
+        std::vector<quadnodeaddr_t> live;
+        std::vector<quadnodeaddr_t> pending(1, _root);
+        while (!pending.empty())
+        {
+            quadnodeaddr_t addr = pending.back();
+            pending.pop_back();
+            live.push_back(addr);
+            const QuadNode &node = _nodeManager.getNode(addr);
+            quadnodeaddr_t children[4] = {node.ne, node.nw, node.sw, node.se};
+            for (quadnodeaddr_t child : children)
             {
-                double dist = currentNode._point->distance(p);
-                Pair<double, Point> d(dist, *currentNode._point);
-                if (currentNode._point->isActive())
+                if (child != INVALIDADDR)
                 {
-                    if (pq.size() < K)
-                    {
-                        pq.push(d);
-                    }
-                    else if (dist < pq.top().getFirst())
-                    {
-                        pq.pop();
-                        pq.push(d);
-                    }
+                    pending.push_back(child);
                 }
             }
         }
-        catch (const std::exception &e)
+
+        // Cada nó é posicionado na curva pelo seu ponto ou, nas folhas, pelo centro de seus limites
+        std::vector<Point> anchors(live.size());
+        for (size_t i = 0; i < live.size(); i++)
+        {
+            const QuadNode &node = _nodeManager.getNode(live[i]);
+            anchors[i] = node._hasPoint ? Point(node._x, node._y) : Point((static_cast<double>(node._lbx) + node._rtx) / 2, (static_cast<double>(node._lby) + node._rty) / 2);
+        }
+
+        // As coordenadas são levadas à grade da curva dentro do retângulo que envolve os pontos
+        double minX = anchors[0].getX(), maxX = anchors[0].getX();
+        double minY = anchors[0].getY(), maxY = anchors[0].getY();
+        for (const Point &anchor : anchors)
         {
-            std::cerr << "Erro ao acessar o nó: " << e.what() << '\n';
+            minX = std::min(minX, anchor.getX());
+            maxX = std::max(maxX, anchor.getX());
+            minY = std::min(minY, anchor.getY());
+            maxY = std::max(maxY, anchor.getY());
         }
+        double scaleX = (maxX > minX) ? 4294967295.0 / (maxX - minX) : 0;
+        double scaleY = (maxY > minY) ? 4294967295.0 / (maxY - minY) : 0;
+
+        std::vector<Pair<uint64_t, quadnodeaddr_t>> keys;
+        keys.reserve(live.size());
+        for (size_t i = 0; i < live.size(); i++)
+        {
+            uint32_t x = static_cast<uint32_t>((anchors[i].getX() - minX) * scaleX);
+            uint32_t y = static_cast<uint32_t>((anchors[i].getY() - minY) * scaleY);
+            uint64_t key = (order == MORTON_ORDER) ? mortonKey(x, y) : hilbertKey(x, y);
+            keys.push_back(Pair<uint64_t, quadnodeaddr_t>(key, live[i]));
+        }
+        std::stable_sort(keys.begin(), keys.end(), [](const Pair<uint64_t, quadnodeaddr_t> &a, const Pair<uint64_t, quadnodeaddr_t> &b)
+                         { return a.getFirst() < b.getFirst(); });
+        for (const Pair<uint64_t, quadnodeaddr_t> &key : keys)
+        {
+            sequence.push_back(key.getSecond());
+        }
+    }
+
+    // Os nós livres vão para o fim do vetor e são descartados
+    size_t numLive = sequence.size();
+    std::vector<bool> placed(size, false);
+    for (quadnodeaddr_t addr : sequence)
+    {
+        placed[addr] = true;
+    }
+    for (size_t i = 0; i < size; i++)
+    {
+        if (!placed[i])
+        {
+            sequence.push_back(i);
+        }
+    }
+
+    std::vector<quadnodeaddr_t> newAddr(size);
+    for (size_t i = 0; i < size; i++)
+    {
+        newAddr[sequence[i]] = i;
     }
+    _root = newAddr[_root];
+    _nodeManager.permute(newAddr);
+    _nodeManager.truncate(numLive);
 }
 
-void QuadTree::HeuristicKNNSearch(const Point &p, int K, PriorityQueue<Pair<double, Point>> &pq)
+void QuadTree::vebOrder(quadnodeaddr_t addr, int levels, std::vector<quadnodeaddr_t> &order) const
 {
-    PriorityQueue<Pair<double, quadnodeaddr_t>> pq_aux(100, true);
-    pq_aux.push(Pair<double, quadnodeaddr_t>(0, _root));
+    if (levels == 1)
+    {
+        order.push_back(addr);
+        return;
+    }
+
+    // Primeiro a metade de cima, depois cada subárvore pendurada abaixo dela
+    int top = levels / 2;
+    vebOrder(addr, top, order);
 
-    size_t visited = 0;
-    size_t stagnated = 0;
-    while (!pq_aux.empty() && (stagnated <= 10))
+    std::vector<quadnodeaddr_t> bottoms;
+    descendantsAt(addr, top, bottoms);
+    for (quadnodeaddr_t bottom : bottoms)
     {
-        quadnodeaddr_t current = pq_aux.top().getSecond();
-        pq_aux.pop();
+        vebOrder(bottom, levels - top, order);
+    }
+}
+
+void QuadTree::descendantsAt(quadnodeaddr_t addr, int depth, std::vector<quadnodeaddr_t> &out) const
+{
+    if (depth == 0)
+    {
+        out.push_back(addr);
+        return;
+    }
+    const QuadNode &node = _nodeManager.getNode(addr);
+    quadnodeaddr_t children[4] = {node.ne, node.nw, node.sw, node.se};
+    for (quadnodeaddr_t child : children)
+    {
+        if (child != INVALIDADDR)
+        {
+            descendantsAt(child, depth - 1, out);
+        }
+    }
+}
 
-        try
+int QuadTree::height(quadnodeaddr_t addr) const
+{
+    const QuadNode &node = _nodeManager.getNode(addr);
+    quadnodeaddr_t children[4] = {node.ne, node.nw, node.sw, node.se};
+    int tallest = 0;
+    for (quadnodeaddr_t child : children)
+    {
+        if (child != INVALIDADDR)
         {
-            QuadNode currentNode = _nodeManager.getNode(current);
+            tallest = std::max(tallest, height(child));
+        }
+    }
+    return tallest + 1;
+}
+
+void QuadTree::activate(Point &p)
+{
+    if (!p.isActive() && updateActiveCount(p, 1))
+    {
+        p.activate();
+    }
+}
+
+void QuadTree::deactivate(Point &p)
+{
+    if (p.isActive() && updateActiveCount(p, -1))
+    {
+        p.deactivate();
+    }
+}
 
-            if (!currentNode._boundary.contains(p))
+bool QuadTree::updateActiveCount(const Point &p, long delta)
+{
+    // Confirma que o ponto está na árvore antes de alterar os contadores do caminho
+    quadnodeaddr_t current = _root;
+    int slot = -1; // Posição do ponto no balde, se ele estiver em uma folha
+    while (current != INVALIDADDR && !_nodeManager.holds(current, p))
+    {
+        if (!_nodeManager.nodes[current]._hasPoint)
+        {
+            slot = _nodeManager.bucketSlot(current, p);
+            if (slot < 0)
             {
-                continue;
+                return false;
             }
-            visited++;
+            break;
+        }
+        current = _nodeManager.child(current, p);
+    }
+    if (current == INVALIDADDR)
+    {
+        return false;
+    }
 
-            const Point *ponto = currentNode._point;
+    for (current = _root;; current = _nodeManager.child(current, p))
+    {
+        _nodeManager.nodes[current]._activeCount += delta;
+        if (_nodeManager.holds(current, p))
+        {
+            _nodeManager.nodes[current]._active = delta > 0;
+            return true;
+        }
+        if (!_nodeManager.nodes[current]._hasPoint)
+        {
+            int32_t bucket = _nodeManager.nodes[current]._bucket;
+            _nodeManager.bucketActive[static_cast<size_t>(bucket) * _nodeManager._bucketSize + slot] = delta > 0;
+            return true;
+        }
+    }
+}
 
-            if (ponto != nullptr)
-            {
-                double dist = ponto->distance(p);
+void QuadTree::destroy()
+{
+    _nodeManager.destroy();
+}
 
-                Pair<double, Point> d(dist, *ponto);
-                if (ponto->isActive())
-                {
-                    if (pq.size() < K)
-                    {
-                        pq.push(d);
-                        stagnated = 0;
-                    }
-                    else if (dist < pq.top().getFirst())
-                    {
-                        pq.pop();
-                        pq.push(d);
-                        stagnated = 0;
-                    }
-                    else
-                    {
-                        stagnated++;
-                    }
-                }
+/**
+ * @brief Limite inferior para o quadrado da distância entre p e qualquer ponto contido em box (MINDIST²).
+ */
+double heuristic(const Point &p, const Rectangle &box)
+{
+    return box.minDistanceSquared(p);
+}
+
+/**
+ * @brief Retorna a fila de prioridade (mínima) da fronteira de busca da thread atual, vazia.
+ *
+ * A fila é criada uma vez por thread e reaproveitada entre as consultas: ela cresce até o tamanho da maior
+ * fronteira já vista e não é realocada nas consultas seguintes.
+ *
+ * @return Referência para a fila da thread atual.
+ */
+PriorityQueue<Pair<double, quadnodeaddr_t>> &searchFrontier()
+{
+    static thread_local PriorityQueue<Pair<double, quadnodeaddr_t>> frontier(64, true);
+    frontier.clear();
+    return frontier;
+}
+
+void QuadTree::scanBucket(const QuadNode &leaf, const Point &p, int K, BoundedPriorityQueue<Pair<double, Point>> &pq) const
+{
+    // Copia os campos da folha antes de ler o balde, que pode estar em outra página do SMV
+    int32_t bucket = leaf._bucket;
+    int count = leaf._bucketCount;
+    if (count == 0)
+    {
+        return;
+    }
+
+    const double *xs = _nodeManager.bucketCoords(bucket);
+    const double *ys = xs + _nodeManager._bucketSize;
+    const uint8_t *active = &_nodeManager.bucketActive[static_cast<size_t>(bucket) * _nodeManager._bucketSize];
 
-                // Add child nodes to priority queue
-                if (currentNode.ne != INVALIDADDR)
+    // As distâncias são calculadas antes de consultar o estado, que fica fora do SMV
+    double dists[MAXBUCKETSIZE];
+    squaredDistances(xs, ys, count, p.getX(), p.getY(), dists);
+    for (int i = 0; i < count; i++)
+    {
+        double dist = dists[i];
+        if (pq.size() == K && dist >= pq.top().getFirst())
+        {
+            continue;
+        }
+        if (!active[i])
+        {
+            continue;
+        }
+        Point point(xs[i], ys[i], _nodeManager.bucketStations[static_cast<size_t>(bucket) * _nodeManager._bucketSize + i], true);
+        if (pq.size() < K)
+        {
+            pq.push(Pair<double, Point>(dist, point));
+        }
+        else
+        {
+            pq.replaceTop(Pair<double, Point>(dist, point));
+        }
+    }
+}
+
+void QuadTree::HeuristicKNNSearch(const Point &p, int K, BoundedPriorityQueue<Pair<double, Point>> &pq) const
+{
+    if (K <= 0 || _nodeManager._size == 0)
+    {
+        return;
+    }
+
+    PriorityQueue<Pair<double, quadnodeaddr_t>> &pq_aux = searchFrontier();
+    pq_aux.push(Pair<double, quadnodeaddr_t>(0, _root));
+
+    while (!pq_aux.empty())
+    {
+        // O topo da fila é o menor limite inferior entre os nós ainda não visitados:
+        // se ele não supera o K-ésimo melhor ponto, a resposta já é exata.
+        if (pq.size() == K && pq_aux.top().getFirst() >= pq.top().getFirst())
+        {
+            break;
+        }
+
+        quadnodeaddr_t current = pq_aux.top().getSecond();
+        pq_aux.pop();
+
+        const QuadNode &currentNode = _nodeManager.getNode(current);
+
+        // Subárvores sem estações ativas são descartadas por inteiro
+        if (currentNode._activeCount == 0)
+        {
+            continue;
+        }
+
+        if (currentNode._hasPoint)
+        {
+            if (currentNode._active)
+            {
+                double dist = currentNode.distanceSquared(p);
+                if (pq.size() < K)
                 {
-                    double heuristicDist = heuristic(p, _nodeManager.getNode(currentNode.ne)._boundary);
-                    pq_aux.push(Pair<double, quadnodeaddr_t>(heuristicDist, currentNode.ne));
+                    pq.push(Pair<double, Point>(dist, _nodeManager.getPoint(current)));
                 }
-                if (currentNode.nw != INVALIDADDR)
+                else if (dist < pq.top().getFirst())
                 {
-                    double heuristicDist = heuristic(p, _nodeManager.getNode(currentNode.nw)._boundary);
-                    pq_aux.push(Pair<double, quadnodeaddr_t>(heuristicDist, currentNode.nw));
+                    pq.replaceTop(Pair<double, Point>(dist, _nodeManager.getPoint(current)));
                 }
-                if (currentNode.sw != INVALIDADDR)
+            }
+
+            // Os quadrantes dos filhos são derivados do ponto deste nó, como em localize,
+            // evitando acessar os filhos que serão podados.
+            quadnodeaddr_t children[4] = {currentNode.ne, currentNode.nw, currentNode.sw, currentNode.se};
+
+            for (int q = 0; q < 4; q++)
+            {
+                if (children[q] == INVALIDADDR)
                 {
-                    double heuristicDist = heuristic(p, _nodeManager.getNode(currentNode.sw)._boundary);
-                    pq_aux.push(Pair<double, quadnodeaddr_t>(heuristicDist, currentNode.sw));
+                    continue;
                 }
-                if (currentNode.se != INVALIDADDR)
+                double heuristicDist = heuristic(p, _nodeManager.quadrantBoundary(current, q));
+                if (pq.size() < K || heuristicDist < pq.top().getFirst())
                 {
-                    double heuristicDist = heuristic(p, _nodeManager.getNode(currentNode.se)._boundary);
-                    pq_aux.push(Pair<double, quadnodeaddr_t>(heuristicDist, currentNode.se));
+                    pq_aux.push(Pair<double, quadnodeaddr_t>(heuristicDist, children[q]));
                 }
             }
         }
-        catch (const std::exception &e)
+        else
         {
-            std::cerr << "Erro ao acessar o nó: " << e.what() << '\n';
+            scanBucket(currentNode, p, K, pq);
         }
     }
 }
@@ -0,0 +1,603 @@
+#include "ReplacementPolicy.h"
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#define NOLIST -1
+
+/**
+ * @class PageLists
+ * @brief Conjunto de listas duplamente encadeadas de páginas, embutidas em vetores indexados pela página.
+ *
+ * Cada página está em no máximo uma lista, e todas as operações são O(1). O início de cada lista guarda a
+ * página inserida mais recentemente, e o fim a mais antiga.
+ */
+class PageLists
+{
+public:
+    PageLists(int numPages, int numLists)
+        : _prev(numPages, -1), _next(numPages, -1), _owner(numPages, NOLIST),
+          _head(numLists, -1), _tail(numLists, -1), _count(numLists, 0)
+    {
+    }
+
+    /**
+     * @brief Insere no início de uma lista uma página que não está em nenhuma lista.
+     */
+    void pushFront(int list, int page)
+    {
+        _owner[page] = list;
+        _prev[page] = -1;
+        _next[page] = _head[list];
+        if (_head[list] != -1)
+        {
+            _prev[_head[list]] = page;
+        }
+        else
+        {
+            _tail[list] = page;
+        }
+        _head[list] = page;
+        _count[list]++;
+    }
+
+    /**
+     * @brief Retira uma página da lista em que está, se estiver em alguma.
+     */
+    void remove(int page)
+    {
+        int list = _owner[page];
+        if (list == NOLIST)
+        {
+            return;
+        }
+        if (_prev[page] != -1)
+        {
+            _next[_prev[page]] = _next[page];
+        }
+        else
+        {
+            _head[list] = _next[page];
+        }
+        if (_next[page] != -1)
+        {
+            _prev[_next[page]] = _prev[page];
+        }
+        else
+        {
+            _tail[list] = _prev[page];
+        }
+        _prev[page] = _next[page] = -1;
+        _owner[page] = NOLIST;
+        _count[list]--;
+    }
+
+    /**
+     * @brief Move uma página para o início de uma lista.
+     */
+    void moveToFront(int list, int page)
+    {
+        remove(page);
+        pushFront(list, page);
+    }
+
+    int back(int list) const { return _tail[list]; }            /**< Página mais antiga da lista, ou -1 */
+    int towardsFront(int page) const { return _prev[page]; }    /**< Página inserida logo depois, ou -1 */
+    int size(int list) const { return _count[list]; }           /**< Número de páginas da lista */
+    int listOf(int page) const { return _owner[page]; }         /**< Lista da página, ou NOLIST */
+
+private:
+    std::vector<int> _prev, _next, _owner;
+    std::vector<int> _head, _tail, _count;
+};
+
+/**
+ * @brief LRU: as páginas em memória ficam em ordem de acesso, e sai a do fim da lista.
+ */
+class LRUPolicy : public ReplacementPolicy
+{
+public:
+    explicit LRUPolicy(int numPages) : _lists(numPages, 1) {}
+
+    void access(int page) override { _lists.moveToFront(0, page); }
+
+    void load(int page) override { _lists.pushFront(0, page); }
+
+    int evict(int) override
+    {
+        int victim = _lists.back(0);
+        if (victim != -1)
+        {
+            _lists.remove(victim);
+        }
+        return victim;
+    }
+
+private:
+    PageLists _lists;
+};
+
+/**
+ * @brief CLOCK: as páginas formam um círculo percorrido por um ponteiro a partir da mais antiga. Uma página
+ * com o bit de referência ligado tem o bit desligado e passa para trás do ponteiro; sai a primeira sem o bit.
+ */
+class ClockPolicy : public ReplacementPolicy
+{
+public:
+    explicit ClockPolicy(int numPages) : _lists(numPages, 1), _referenced(numPages, false) {}
+
+    void access(int page) override { _referenced[page] = true; }
+
+    void load(int page) override
+    {
+        _lists.pushFront(0, page);
+        _referenced[page] = true;
+    }
+
+    int evict(int) override
+    {
+        // Termina em no máximo uma volta, depois da qual todos os bits estão desligados
+        for (int hand = _lists.back(0); hand != -1; hand = _lists.back(0))
+        {
+            if (!_referenced[hand])
+            {
+                _lists.remove(hand);
+                return hand;
+            }
+            _referenced[hand] = false;
+            _lists.moveToFront(0, hand);
+        }
+        return -1;
+    }
+
+private:
+    PageLists _lists;
+    std::vector<bool> _referenced;
+};
+
+/**
+ * @brief Segunda chance com bits de referência e de modificação: procura, a partir da página mais antiga,
+ * uma página não referenciada e limpa; depois, uma não referenciada e modificada, desligando o bit de
+ * referência das que ficam. Páginas limpas saem antes, pois não precisariam ser gravadas no disco.
+ */
+class SecondChancePolicy : public ReplacementPolicy
+{
+public:
+    explicit SecondChancePolicy(int numPages) : _lists(numPages, 1), _referenced(numPages, false), _modified(numPages, false) {}
+
+    void access(int page) override { _referenced[page] = true; }
+
+    void modify(int page) override { _modified[page] = true; }
+
+    void load(int page) override
+    {
+        _lists.pushFront(0, page);
+        _referenced[page] = true;
+        _modified[page] = false;
+    }
+
+    int evict(int) override
+    {
+        // Depois da segunda busca todos os bits de referência estão desligados, então a próxima rodada encontra
+        // uma vítima
+        for (int round = 0; round < 2; round++)
+        {
+            for (int page = _lists.back(0); page != -1; page = _lists.towardsFront(page))
+            {
+                if (!_referenced[page] && !_modified[page])
+                {
+                    return take(page);
+                }
+            }
+            for (int page = _lists.back(0); page != -1; page = _lists.towardsFront(page))
+            {
+                if (!_referenced[page])
+                {
+                    return take(page);
+                }
+                _referenced[page] = false;
+            }
+        }
+        return -1;
+    }
+
+private:
+    int take(int page)
+    {
+        _lists.remove(page);
+        return page;
+    }
+
+    PageLists _lists;
+    std::vector<bool> _referenced;
+    std::vector<bool> _modified;
+};
+
+/**
+ * @brief 2Q (Johnson e Shasha): páginas novas entram em uma fila FIFO (A1in). Ao sair dela, a página é lembrada
+ * em uma fila fantasma (A1out), e só quem volta enquanto ainda é lembrado entra na LRU principal (Am). Assim,
+ * uma varredura que toca cada página uma vez não expulsa as páginas usadas com frequência.
+ */
+class TwoQPolicy : public ReplacementPolicy
+{
+public:
+    TwoQPolicy(int numPages, int capacity)
+        : _lists(numPages, 3), _kin(std::max(1, capacity / 4)), _kout(std::max(1, capacity / 2))
+    {
+    }
+
+    void access(int page) override
+    {
+        // Um reacesso dentro de A1in não conta: costuma ser a mesma rajada que carregou a página
+        if (_lists.listOf(page) == AM)
+        {
+            _lists.moveToFront(AM, page);
+        }
+    }
+
+    void load(int page) override
+    {
+        if (_lists.listOf(page) == A1OUT)
+        {
+            _lists.remove(page);
+            _lists.pushFront(AM, page);
+        }
+        else
+        {
+            _lists.pushFront(A1IN, page);
+        }
+    }
+
+    int evict(int) override
+    {
+        if (_lists.size(A1IN) > _kin || _lists.size(AM) == 0)
+        {
+            int victim = _lists.back(A1IN);
+            if (victim != -1)
+            {
+                _lists.remove(victim);
+                _lists.pushFront(A1OUT, victim);
+                if (_lists.size(A1OUT) > _kout)
+                {
+                    _lists.remove(_lists.back(A1OUT));
+                }
+                return victim;
+            }
+        }
+        int victim = _lists.back(AM);
+        if (victim != -1)
+        {
+            _lists.remove(victim);
+        }
+        return victim;
+    }
+
+private:
+    enum
+    {
+        A1IN,
+        A1OUT,
+        AM
+    };
+
+    PageLists _lists;
+    int _kin;  /**< Tamanho alvo de A1in */
+    int _kout; /**< Número de páginas lembradas em A1out */
+};
+
+/**
+ * @brief ARC (Megiddo e Modha): T1 guarda as páginas acessadas uma vez e T2 as reacessadas, e as listas
+ * fantasmas B1 e B2 lembram as que saíram de cada uma. Um acerto em B1 aumenta o espaço alvo de T1 (p), e um
+ * acerto em B2 o diminui, de modo que a política se ajusta entre recência e frequência.
+ */
+class ARCPolicy : public ReplacementPolicy
+{
+public:
+    ARCPolicy(int numPages, int capacity) : _lists(numPages, 4), _capacity(std::max(1, capacity)), _target(0), _adapted(-1) {}
+
+    void access(int page) override { _lists.moveToFront(T2, page); }
+
+    void load(int page) override
+    {
+        if (_adapted != page)
+        {
+            adapt(page);
+        }
+        _adapted = -1;
+
+        int list = _lists.listOf(page);
+        if (list == B1 || list == B2)
+        {
+            _lists.moveToFront(T2, page);
+        }
+        else
+        {
+            _lists.pushFront(T1, page);
+        }
+        trimGhosts();
+    }
+
+    int evict(int incoming) override
+    {
+        // O alvo é ajustado antes da escolha da vítima, como em REPLACE; load não o ajusta de novo
+        adapt(incoming);
+        _adapted = incoming;
+
+        int t1 = _lists.size(T1);
+        int victim;
+        if (t1 > 0 && (t1 > _target || (t1 == _target && _lists.listOf(incoming) == B2) || _lists.size(T2) == 0))
+        {
+            victim = _lists.back(T1);
+            _lists.remove(victim);
+            _lists.pushFront(B1, victim);
+        }
+        else
+        {
+            victim = _lists.back(T2);
+            if (victim == -1)
+            {
+                return -1;
+            }
+            _lists.remove(victim);
+            _lists.pushFront(B2, victim);
+        }
+        trimGhosts();
+        return victim;
+    }
+
+private:
+    enum
+    {
+        T1,
+        T2,
+        B1,
+        B2
+    };
+
+    /**
+     * @brief Ajusta o espaço alvo de T1 quando a página carregada é lembrada por uma das listas fantasmas.
+     */
+    void adapt(int page)
+    {
+        int b1 = _lists.size(B1), b2 = _lists.size(B2);
+        if (_lists.listOf(page) == B1)
+        {
+            _target = std::min(_capacity, _target + std::max(b2 / b1, 1));
+        }
+        else if (_lists.listOf(page) == B2)
+        {
+            _target = std::max(0, _target - std::max(b1 / b2, 1));
+        }
+    }
+
+    /**
+     * @brief Mantém |T1| + |B1| <= c e o total das quatro listas <= 2c, esquecendo as páginas fantasmas mais antigas.
+     */
+    void trimGhosts()
+    {
+        while (_lists.size(T1) + _lists.size(B1) > _capacity && _lists.size(B1) > 0)
+        {
+            _lists.remove(_lists.back(B1));
+        }
+        while (_lists.size(T1) + _lists.size(T2) + _lists.size(B1) + _lists.size(B2) > 2 * _capacity)
+        {
+            int ghost = _lists.size(B2) > 0 ? _lists.back(B2) : _lists.back(B1);
+            if (ghost == -1)
+            {
+                break;
+            }
+            _lists.remove(ghost);
+        }
+    }
+
+    PageLists _lists;
+    int _capacity; /**< Número de páginas em memória (c) */
+    int _target;   /**< Tamanho alvo de T1 (p) */
+    int _adapted;  /**< Página para a qual evict já ajustou o alvo, ou -1 */
+};
+
+/**
+ * @brief LFU: sai a página com menos acessos desde que foi carregada e, entre essas, a acessada há mais tempo.
+ *
+ * As páginas com o mesmo número de acessos ficam em uma lista (um balde), em ordem de acesso, e os baldes
+ * não vazios formam uma lista em ordem crescente de acessos. Um acesso move a página para o balde seguinte,
+ * criado se necessário, e a vítima é o fim do primeiro balde, todos em O(1). Como cada balde tem ao menos
+ * uma página, bastam numPages baldes, alocados no construtor junto com as listas.
+ */
+class LFUPolicy : public ReplacementPolicy
+{
+public:
+    explicit LFUPolicy(int numPages)
+        : _lists(numPages, numPages), _count(numPages, 0), _lower(numPages, -1), _higher(numPages, -1), _lowest(-1)
+    {
+        _freeBuckets.reserve(numPages);
+        for (int b = numPages - 1; b >= 0; b--)
+        {
+            _freeBuckets.push_back(b);
+        }
+    }
+
+    void access(int page) override
+    {
+        int bucket = _lists.listOf(page);
+        int next = _higher[bucket];
+        if (next == -1 || _count[next] != _count[bucket] + 1)
+        {
+            if (_lists.size(bucket) == 1)
+            {
+                // A página está sozinha no balde, que passa a ser o de count + 1 sem sair do lugar. Assim só
+                // se cria um balde quando o atual tem outras páginas, e nunca há mais baldes que páginas.
+                _count[bucket]++;
+                return;
+            }
+            next = createBucket(_count[bucket] + 1, bucket);
+        }
+        _lists.moveToFront(next, page);
+        releaseIfEmpty(bucket);
+    }
+
+    void load(int page) override
+    {
+        int bucket = _lowest;
+        if (bucket == -1 || _count[bucket] != 1)
+        {
+            bucket = createBucket(1, -1);
+        }
+        _lists.pushFront(bucket, page);
+    }
+
+    int evict(int) override
+    {
+        if (_lowest == -1)
+        {
+            return -1;
+        }
+        int bucket = _lowest;
+        int victim = _lists.back(bucket);
+        _lists.remove(victim);
+        releaseIfEmpty(bucket);
+        return victim;
+    }
+
+private:
+    /**
+     * @brief Cria um balde vazio para count acessos logo depois de after (ou no início, se after for -1).
+     */
+    int createBucket(long count, int after)
+    {
+        int bucket = _freeBuckets.back();
+        _freeBuckets.pop_back();
+        _count[bucket] = count;
+        _lower[bucket] = after;
+        _higher[bucket] = after == -1 ? _lowest : _higher[after];
+        if (_higher[bucket] != -1)
+        {
+            _lower[_higher[bucket]] = bucket;
+        }
+        if (after == -1)
+        {
+            _lowest = bucket;
+        }
+        else
+        {
+            _higher[after] = bucket;
+        }
+        return bucket;
+    }
+
+    /**
+     * @brief Retira um balde da lista de baldes, se ele ficou vazio.
+     */
+    void releaseIfEmpty(int bucket)
+    {
+        if (_lists.size(bucket) > 0)
+        {
+            return;
+        }
+        if (_lower[bucket] != -1)
+        {
+            _higher[_lower[bucket]] = _higher[bucket];
+        }
+        else
+        {
+            _lowest = _higher[bucket];
+        }
+        if (_higher[bucket] != -1)
+        {
+            _lower[_higher[bucket]] = _lower[bucket];
+        }
+        _lower[bucket] = _higher[bucket] = -1;
+        _freeBuckets.push_back(bucket);
+    }
+
+    PageLists _lists;              /**< Páginas de cada balde, da acessada mais recentemente para a mais antiga */
+    std::vector<long> _count;      /**< Número de acessos das páginas de cada balde */
+    std::vector<int> _lower;       /**< Balde anterior, com menos acessos, ou -1 */
+    std::vector<int> _higher;      /**< Balde seguinte, com mais acessos, ou -1 */
+    std::vector<int> _freeBuckets; /**< Baldes livres, com capacidade reservada para todos */
+    int _lowest;                   /**< Balde com menos acessos, ou -1 se não há páginas em memória */
+};
+
+/**
+ * @brief Aleatória: sai uma página em memória sorteada, com semente fixa para que as execuções se repitam.
+ */
+class RandomPolicy : public ReplacementPolicy
+{
+public:
+    explicit RandomPolicy(int numPages) : _position(numPages, -1), _gen(42)
+    {
+        _resident.reserve(numPages); // load não aloca dentro do tratador de sinal
+    }
+
+    void access(int) override {}
+
+    void load(int page) override
+    {
+        _position[page] = _resident.size();
+        _resident.push_back(page);
+    }
+
+    int evict(int) override
+    {
+        if (_resident.empty())
+        {
+            return -1;
+        }
+        std::uniform_int_distribution<int> pick(0, _resident.size() - 1);
+        int victim = _resident[pick(_gen)];
+        // A última página ocupa o lugar da vítima
+        int last = _resident.back();
+        _resident[_position[victim]] = last;
+        _position[last] = _position[victim];
+        _resident.pop_back();
+        _position[victim] = -1;
+        return victim;
+    }
+
+private:
+    std::vector<int> _resident; /**< Páginas em memória */
+    std::vector<int> _position; /**< Posição de cada página em _resident, ou -1 */
+    std::mt19937 _gen;
+};
+
+static const char *const policyNames[NUMREPLACEMENTPOLICIES] = {"lru", "clock", "second-chance", "2q", "arc", "lfu", "random"};
+
+ReplacementPolicy *createReplacementPolicy(ReplacementPolicyKind kind, int numPages, int capacity)
+{
+    switch (kind)
+    {
+    case CLOCK_POLICY:
+        return new ClockPolicy(numPages);
+    case SECOND_CHANCE_POLICY:
+        return new SecondChancePolicy(numPages);
+    case TWOQ_POLICY:
+        return new TwoQPolicy(numPages, capacity);
+    case ARC_POLICY:
+        return new ARCPolicy(numPages, capacity);
+    case LFU_POLICY:
+        return new LFUPolicy(numPages);
+    case RANDOM_POLICY:
+        return new RandomPolicy(numPages);
+    default:
+        return new LRUPolicy(numPages);
+    }
+}
+
+bool parseReplacementPolicy(const std::string &name, ReplacementPolicyKind &kind)
+{
+    for (int i = 0; i < NUMREPLACEMENTPOLICIES; i++)
+    {
+        if (name == policyNames[i])
+        {
+            kind = static_cast<ReplacementPolicyKind>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *replacementPolicyName(ReplacementPolicyKind kind)
+{
+    return policyNames[kind];
+}
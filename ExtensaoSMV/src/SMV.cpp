@@ -1,13 +1,23 @@
 #include "SMV.h"
+#include <algorithm>
 
 SMV *SMV::instance = nullptr;
 
 double SMV::_MEMTOSWAPRATIO = MEMTOSWAPRATIO;
 
+ReplacementPolicyKind SMV::_POLICY = LRU_POLICY;
+
+std::string SMV::_TRACEFILE;
+
+#define OPENPAGESRESERVE 4 /* capacidade inicial da lista de páginas abertas */
+
+#define TRACEBUFFERSIZE 4096 /* registros acumulados antes de cada gravação do traço */
+
 SMV::SMV()
 {
     instance = this;
     std::cout << "MEMTOSWAPRATIO: " << _MEMTOSWAPRATIO << std::endl;
+    std::cout << "REPLACEMENT POLICY: " << replacementPolicyName(_POLICY) << std::endl;
 }
 
 SMV::~SMV()
@@ -51,19 +61,40 @@ char *SMV::initPage(int &bytesAllocated)
         write(swap, pagenull, PAGESIZE);
     }
     std::cout << "Swap file initialized" << std::endl;
+    // Cada falta abre no máximo uma página, então a lista nunca cresce dentro do tratador de sinal
+    openPages.reserve(OPENPAGESRESERVE);
+    // Dimensiona as filas das políticas pelo número máximo de páginas em memória permitido pela razão
+    policy = createReplacementPolicy(_POLICY, NUMPAGE, std::max(1, static_cast<int>(NUMPAGE * _MEMTOSWAPRATIO)));
     if (mprotect(logpage, NUMPAGE * PAGESIZE, PROT_NONE))
     {
         throw std::runtime_error("mprotect failed on logpage");
     }
+    if (!_TRACEFILE.empty())
+    {
+        trace = open(_TRACEFILE.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+        if (trace == -1)
+        {
+            throw std::runtime_error("Failed to create trace file");
+        }
+        PageTraceHeader header;
+        header.numPages = NUMPAGE;
+        header.pageSize = PAGESIZE;
+        write(trace, &header, sizeof(header));
+        traceBuffer.reserve(TRACEBUFFERSIZE);
+        std::cout << "Trace file created" << std::endl;
+    }
     std::cout << "SMV initialized" << std::endl;
     return logpage;
 }
 
 void SMV::endPage()
 {
+    long totalAcc = 0, totalDisk = 0;
 
     for (int j = 0; j < NUMPAGE; j++)
     {
+        totalAcc += pvet[j].nacc;
+        totalDisk += pvet[j].ndisk;
         if (pvet[j].nacc)
         {
             std::cout << "Page " << j << ": acc " << pvet[j].nacc
@@ -73,16 +104,33 @@ void SMV::endPage()
                       << " rd " << pvet[j].nread
                       << " dsk " << pvet[j].ndisk << std::endl;
         }
-        if (pvet[j].status & VALID)
+        if (!(pvet[j].status & DISCO))
         {
-            lseek(swap, j * PAGESIZE, SEEK_SET);
-            write(swap, pvet[j].physaddr, PAGESIZE);
-            pvet[j].status &= ~VALID;
-            pvet[j].status |= DISCO;
+            if (pvet[j].status & DIRTY)
+            {
+                memcpy(pvet[j].physaddr, pvet[j].logaddr, PAGESIZE);
+            }
+            writeBack(j);
+            pvet[j].status = DISCO;
             pagesInMemory--;
         }
     }
+    std::cout << "Total: acc " << totalAcc << " dsk " << totalDisk << std::endl;
+    std::cout << "Clean pages not written back: " << cleanWriteBacks << " (" << cleanWriteBacks * PAGESIZE << " bytes saved)" << std::endl;
+    if (trace != -1)
+    {
+        if (tracePage != -1)
+        {
+            traceBuffer.push_back(pageTraceRecord(tracePage, traceWrite));
+            tracePage = -1;
+        }
+        flushTrace();
+        close(trace);
+        trace = -1;
+    }
     close(swap);
+    delete policy;
+    policy = nullptr;
     delete[] raw_physpage;
     delete[] raw_logpage;
 }
@@ -112,13 +160,34 @@ void SMV::handleSegv(int sig, siginfo_t *sip, void *context)
     }
 }
 
-void SMV::segvHandler(int sig, siginfo_t *sip, ucontext_t *uap)
+void SMV::traceReference(int i, bool newReference, bool writing)
 {
-    unsigned int i = (reinterpret_cast<caddr_t>(sip->si_addr) - logpage) / PAGESIZE;
-    pvet[i].nacc++;
-    pvet[i].lastAccessTime = std::chrono::system_clock::now().time_since_epoch().count(); // Atualiza o tempo de acesso
+    if (!newReference)
+    {
+        traceWrite = traceWrite || writing;
+        return;
+    }
+    if (tracePage != -1)
+    {
+        traceBuffer.push_back(pageTraceRecord(tracePage, traceWrite));
+        if (traceBuffer.size() == TRACEBUFFERSIZE)
+        {
+            flushTrace();
+        }
+    }
+    tracePage = i;
+    traceWrite = writing;
+}
 
-    for (int c = 0; c < NUMPAGE; c++)
+void SMV::flushTrace()
+{
+    write(trace, traceBuffer.data(), traceBuffer.size() * sizeof(uint32_t));
+    traceBuffer.clear();
+}
+
+void SMV::closeOpenPages(int i)
+{
+    for (int c : openPages)
     {
         if (pvet[c].status & DIRTY)
         {
@@ -126,49 +195,82 @@ void SMV::segvHandler(int sig, siginfo_t *sip, ucontext_t *uap)
             pvet[c].status |= VALID;
             memcpy(pvet[c].physaddr, pvet[c].logaddr, PAGESIZE);
         }
+        else if ((pvet[c].status & READ) && c != i)
+        {
+            // A página foi só lida: volta a AVAIL para que a próxima falta libere apenas a leitura e uma escrita
+            // continue sendo detectada. A falta na própria página i, se ela está em READ, é uma escrita.
+            pvet[c].status &= ~READ;
+            pvet[c].status |= AVAIL;
+        }
+        if (mprotect(pvet[c].logaddr, PAGESIZE, PROT_NONE))
+        {
+            throw std::runtime_error("mprotect failed");
+        }
     }
+    openPages.clear();
+}
 
-    if (mprotect(logpage, NUMPAGE * PAGESIZE, PROT_NONE))
+void SMV::writeBack(int i)
+{
+    if (!pvet[i].modified)
     {
-        throw std::runtime_error("mprotect failed");
+        cleanWriteBacks++;
+        return;
     }
+    lseek(swap, i * PAGESIZE, SEEK_SET);
+    write(swap, pvet[i].physaddr, PAGESIZE);
+    pvet[i].ndisk++;
+    pvet[i].modified = false;
+}
+
+void SMV::segvHandler(int sig, siginfo_t *sip, ucontext_t *uap)
+{
+    unsigned int i = (reinterpret_cast<caddr_t>(sip->si_addr) - logpage) / PAGESIZE;
+    pvet[i].nacc++;
+    // Faltas seguidas na mesma página fazem parte da mesma referência, e uma falta em uma página liberada só
+    // para leitura é uma escrita
+    bool newReference = static_cast<int>(i) != lastFaultPage;
+    bool writing = pvet[i].status & READ;
+    lastFaultPage = i;
+    if (trace != -1)
+    {
+        traceReference(i, newReference, writing);
+    }
+
+    if (newReference && !(pvet[i].status & DISCO))
+    {
+        policy->access(i);
+    }
+    if (writing)
+    {
+        policy->modify(i);
+    }
+
+    closeOpenPages(i);
 
     if (pvet[i].status & DISCO)
     {
         // Se a página atual está marcada como "DISCO" (não válida na memória), precisamos processá-la para substituição
 
         // Verifica se a memória em uso excedeu a capacidade permitida pela razão de memória
+        int discard = -1;
         if (pagesInMemory + 1 > NUMPAGE * _MEMTOSWAPRATIO)
         {
-            // Encontrar a página menos recentemente usada (LRU)
-            unsigned long oldestAccessTime = std::chrono::system_clock::now().time_since_epoch().count();
-            int discard = -1;
-
-            // Itera sobre todas as páginas para encontrar a menos recentemente usada
-            for (int j = 0; j < NUMPAGE; j++)
-            {
-                // Verifica se a página é válida e se seu tempo de acesso é o mais antigo encontrado até agora
-                if (pvet[j].status & VALID && pvet[j].lastAccessTime < oldestAccessTime)
-                {
-                    oldestAccessTime = pvet[j].lastAccessTime;
-                    discard = j; // Armazena o índice da página a ser descartada
-                }
-            }
+            // Como as páginas sujas acabaram de ser copiadas para a memória física e todas estão protegidas,
+            // a política pode escolher qualquer página em memória
+            discard = policy->evict(i);
+        }
+        if (discard != -1)
+        {
 
-            // Se uma página a ser descartada foi encontrada
-            if (discard != -1)
-            {
-                // Move o ponteiro para o início da área de troca (swap) da página a ser descartada
-                lseek(swap, discard * PAGESIZE, SEEK_SET);
-                // Grava a página na área de troca
-                write(swap, pvet[discard].physaddr, PAGESIZE);
-                // Atualiza o status da página: remove o status VALID e adiciona DISCO
-                pvet[discard].status &= ~VALID;
-                pvet[discard].status |= DISCO;
-                // Reduz o número de páginas na memória
-                pagesInMemory--;
-                std::cout << "Page " << discard << " swapped out" << std::endl;
-            }
+            // Grava a página na área de troca, se ela foi escrita desde que foi carregada
+            writeBack(discard);
+            // Atualiza o status da página: remove o estado em memória e adiciona DISCO
+            pvet[discard].status &= ~(VALID | AVAIL | READ);
+            pvet[discard].status |= DISCO;
+            // Reduz o número de páginas na memória
+            pagesInMemory--;
+            std::cout << "Page " << discard << " swapped out" << std::endl;
         }
 
         // Atualiza a página atual para o status VALID
@@ -180,6 +282,7 @@ void SMV::segvHandler(int sig, siginfo_t *sip, ucontext_t *uap)
         read(swap, pvet[i].physaddr, PAGESIZE);
         // Aumenta o número de páginas na memória
         pagesInMemory++;
+        policy->load(i);
     }
     else if (pvet[i].status & VALID)
     {
@@ -203,15 +306,18 @@ void SMV::segvHandler(int sig, siginfo_t *sip, ucontext_t *uap)
         {
             throw std::runtime_error("mprotect failed");
         }
+        openPages.push_back(i);
     }
     else if (pvet[i].status & READ)
     {
         pvet[i].status &= ~READ;
         pvet[i].status |= DIRTY;
+        pvet[i].modified = true;
         if (mprotect(pvet[i].logaddr, PAGESIZE, PROT_READ | PROT_WRITE))
         {
             throw std::runtime_error("mprotect failed");
         }
+        openPages.push_back(i);
     }
 }
 
@@ -232,4 +338,27 @@ void SMV::setMemToSwapRatio(double ratio)
     }
     _MEMTOSWAPRATIO = ratio;
 #endif
+}
+
+ReplacementPolicyKind SMV::getReplacementPolicy()
+{
+    return _POLICY;
+}
+
+void SMV::setReplacementPolicy(ReplacementPolicyKind kind)
+{
+    if (instance != nullptr)
+    {
+        std::cerr << "REPLACEMENT POLICY must be defined before inicialization" << std::endl;
+    }
+    _POLICY = kind;
+}
+
+void SMV::setTraceFile(const std::string &path)
+{
+    if (instance != nullptr)
+    {
+        std::cerr << "TRACE FILE must be defined before inicialization" << std::endl;
+    }
+    _TRACEFILE = path;
 }
\ No newline at end of file
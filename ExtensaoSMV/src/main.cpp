@@ -4,111 +4,157 @@
 #include <vector>
 #include <iomanip>
 #include <cstring>
+#include <cstdlib>
 #include "QuadTree.h"
-#include "Address.h"
+#include "StationArena.h"
 #include "HashTable.h"
 
-HashTable<std::string, AddressInfo> *loadFile(std::ifstream &inputFile, int NumEnderecos, QuadTree &quadTree)
+/**
+ * @brief Lê um identificador de um evento, ignorando os espaços antes dele.
+ * @param c Posição da linha logo após o comando.
+ * @param texto Recebe o identificador como aparece no evento, para as mensagens.
+ * @return O identificador, até o próximo espaço ou o fim da linha, codificado (INVALIDSTATIONID se não faz parte da base).
+ */
+stationid_t lerId(const char *c, std::string &texto)
 {
+    while (*c == ' ' || *c == '\t')
+    {
+        c++;
+    }
+    const char *fim = c;
+    while (*fim != '\0' && *fim != ' ' && *fim != '\t' && *fim != '\r')
+    {
+        fim++;
+    }
+    texto.assign(c, fim);
+    return findStationId(c, fim);
+}
 
-    HashTable<std::string, AddressInfo> *estacoes = new HashTable<std::string, AddressInfo>(NumEnderecos);
+HashTable<stationid_t, stationidx_t> *loadFile(std::ifstream &inputFile, int NumEnderecos, QuadTree &quadTree, StationArena &estacoes)
+{
+    HashTable<stationid_t, stationidx_t> *indice = new HashTable<stationid_t, stationidx_t>(NumEnderecos);
+
+    // Lê o restante do arquivo de uma só vez para o StationArena; os campos são separados no próprio
+    // buffer, terminados por '\0', e os endereços apontam para eles sem copiá-los
+    std::vector<char> &buffer = estacoes.text();
+    std::streampos inicio = inputFile.tellg();
+    inputFile.seekg(0, std::ios::end);
+    buffer.resize(static_cast<size_t>(inputFile.tellg() - inicio) + 1);
+    inputFile.seekg(inicio);
+    inputFile.read(buffer.data(), buffer.size() - 1);
+    buffer[buffer.size() - 1] = '\0'; // Sentinela para strtod e strtol no último campo
+
+    char *c = buffer.data();
+    char *fimBuffer = c + buffer.size() - 1;
+
+    while (c < fimBuffer)
+    {
+        char *fimLinha = static_cast<char *>(memchr(c, '\n', fimBuffer - c));
+        if (fimLinha == nullptr)
+        {
+            fimLinha = fimBuffer;
+        }
 
-    std::string line;
+        // idend;id_logrado;sigla_tipo;nome_logra;numero_imo;nome_bairr;nome_regio;cep;x;y
+        char *campos[10];
+        int numCampos = 0;
+        while (numCampos < 10 && c < fimLinha)
+        {
+            char *sep = static_cast<char *>(memchr(c, ';', fimLinha - c));
+            if (sep == nullptr)
+            {
+                sep = fimLinha;
+            }
+            *sep = '\0';
+            campos[numCampos++] = c;
+            c = sep + 1;
+        }
 
-    while (std::getline(inputFile, line))
-    {
-        std::istringstream iss(line);
-        std::string idend, sid_logrado, sigla_tipo, nome_logra, numero_imo, nome_bairr, nome_regio, scep, sx, sy;
-        double x, y;
-        int cep;
-        long id_logradouro;
-
-        if (std::getline(iss, idend, ';') &&
-            std::getline(iss, sid_logrado, ';') &&
-            std::getline(iss, sigla_tipo, ';') &&
-            std::getline(iss, nome_logra, ';') &&
-            std::getline(iss, numero_imo, ';') &&
-            std::getline(iss, nome_bairr, ';') &&
-            std::getline(iss, nome_regio, ';') &&
-            std::getline(iss, scep, ';') &&
-            std::getline(iss, sx, ';') &&
-            std::getline(iss, sy, ';'))
+        if (numCampos == 10)
+        {
+            stationid_t id = registerStationId(campos[0], campos[0] + strlen(campos[0]));
+            long id_logradouro = strtol(campos[1], nullptr, 10);
+            int cep = static_cast<int>(strtol(campos[7], nullptr, 10));
+            double x = strtod(campos[8], nullptr);
+            double y = strtod(campos[9], nullptr);
+
+            AddressInfo endereco(id, id_logradouro, campos[2], campos[3], campos[4], campos[5], campos[6], cep);
+            indice->insert(id, estacoes.add(x, y, endereco));
+        }
+        else if (numCampos > 0 && !(numCampos == 1 && (*campos[0] == '\0' || *campos[0] == '\r')))
         {
-            id_logradouro = std::stol(sid_logrado);
-            cep = std::stoi(scep);
-            x = std::stod(sx);
-            y = std::stod(sy);
-
-            Point *ponto = new Point(x, y, idend);
-            AddressInfo *estacao = new AddressInfo(*ponto, idend, id_logradouro, sigla_tipo, nome_logra, numero_imo, nome_bairr, nome_regio, cep);
-            quadTree.insert(*ponto);
-            estacoes->insert(idend, estacao);
+            std::cerr << "Linha da base ignorada, com " << numCampos << " campos em vez de 10: " << campos[0] << std::endl;
         }
+        c = fimLinha + 1;
     }
+
+    // Com todas as estações lidas, a árvore é construída balanceada, sem depender da ordem do arquivo
+    std::vector<Point *> pontos(estacoes.size());
+    for (size_t i = 0; i < estacoes.size(); i++)
+    {
+        pontos[i] = &estacoes.point(i);
+    }
+    quadTree.build(pontos);
     inputFile.close();
 
-    return estacoes;
+    return indice;
 }
 
-void consultar(QuadTree &quadTree, HashTable<std::string, AddressInfo> &estacoes, double x, double y, int n)
+void consultar(QuadTree &quadTree, StationArena &estacoes, double x, double y, int n)
 {
-
     Point p(x, y);
-    PriorityQueue<Pair<double, Point>> pq(n);
-    quadTree.KNNSearch(p, n, pq);
+    BoundedPriorityQueue<Pair<double, Point>> pq(n);
+    quadTree.HeuristicKNNSearch(p, n, pq);
 
-    pq.toggleMode();
-    while (!pq.empty())
+    pq.sort();
+    for (const Pair<double, Point> &p : pq)
     {
-        Pair<double, Point> p = pq.top();
-        pq.pop();
-
-        double dist = p.getFirst();
-        std::string id = p.getSecond().getId();
-        AddressInfo *estacao = estacoes.search(id);
+        double dist = sqrt(p.getFirst()); // A busca compara distâncias ao quadrado
+        const AddressInfo &estacao = estacoes.address(p.getSecond().getId());
 
-        if (estacao != nullptr)
-        {
-            std::cout << *estacao << std::fixed << std::setprecision(3) << " (" << dist << ")" << std::endl;
-        }
+        std::cout << estacao << std::fixed << std::setprecision(3) << " (" << dist << ")" << std::endl;
     }
 }
 
-void ativar(QuadTree &quadTree, HashTable<std::string, AddressInfo> &estacoes, int numEnderecos, std::string id)
+void ativar(QuadTree &quadTree, StationArena &estacoes, HashTable<stationid_t, stationidx_t> &indice, int numEnderecos, stationid_t id, const std::string &texto)
 {
-    AddressInfo *estacao = estacoes.search(id);
-    if (estacao == nullptr)
+    stationidx_t *idx = indice.search(id);
+    if (idx == nullptr)
     {
-        std::cout << "Ponto de recarga " << id << " não encontrado." << std::endl;
+        std::cout << "Ponto de recarga " << texto << " não encontrado." << std::endl;
         return;
     }
-    if (!estacao->_ativo)
+    AddressInfo &estacao = estacoes.address(*idx);
+    if (!estacao._ativo)
     {
-        estacao->activate();
-        std::cout << "Ponto de recarga " << id << " ativado." << std::endl;
+        quadTree.activate(estacoes.point(*idx));
+        estacao.activate();
+        std::cout << "Ponto de recarga " << texto << " ativado." << std::endl;
     }
     else
     {
-        std::cout << "Ponto de recarga " << id << " já estava ativo." << std::endl;
+        std::cout << "Ponto de recarga " << texto << " já estava ativo." << std::endl;
     }
 }
 
-void desativar(QuadTree &quadTree, HashTable<std::string, AddressInfo> &estacoes, int numEnderecos, std::string id)
+void desativar(QuadTree &quadTree, StationArena &estacoes, HashTable<stationid_t, stationidx_t> &indice, int numEnderecos, stationid_t id, const std::string &texto)
 {
-    AddressInfo *estacao = estacoes.search(id);
-    if (estacao == nullptr)
+    stationidx_t *idx = indice.search(id);
+    if (idx == nullptr)
     {
-        std::cout << "Ponto de recarga " << id << " não encontrado." << std::endl;
+        std::cout << "Ponto de recarga " << texto << " não encontrado." << std::endl;
         return;
     }
-    if (estacao->_ativo)
+    AddressInfo &estacao = estacoes.address(*idx);
+    if (estacao._ativo)
     {
-        estacao->deactivate();
-        std::cout << "Ponto de recarga " << id << " desativado." << std::endl;
+        quadTree.deactivate(estacoes.point(*idx));
+        estacao.deactivate();
+        std::cout << "Ponto de recarga " << texto << " desativado." << std::endl;
     }
     else
     {
-        std::cout << "Ponto de recarga " << id << " já estava desativado." << std::endl;
+        std::cout << "Ponto de recarga " << texto << " já estava desativado." << std::endl;
     }
 }
 
@@ -116,13 +162,17 @@ int main(int argc, char *argv[])
 {
     bool tFlag = false; // Variável booleana para verificar o codigo esta no modo de teste
 
-    // Verifica se o número de argumentos é suficiente (mínimo de 5, sem contar o -t)
-    if (argc < 5 || argc > 8)
+    // Verifica se o número de argumentos é suficiente (mínimo de 5, sem contar o -t, o -p, o -r, o -o e o -f)
+    if (argc < 5 || argc > 16)
     {
-        std::cerr << "Uso: ./tp3.out -b <arquivo_base> -e <arquivo_eventos> [-t] [MEMTOSWAPRATIO]" << std::endl;
+        std::cerr << "Uso: ./tp3.out -b <arquivo_base> -e <arquivo_eventos> [-t] [MEMTOSWAPRATIO] [-p lru|clock|second-chance|2q|arc|lfu|random] [-r arquivo_traco] [-o morton|hilbert|veb] [-f pontos_por_folha]" << std::endl;
         return 1;
     }
 
+    bool reorderNodes = false; // Renumera os nós da árvore depois da carga
+    NodeOrder nodeOrder = VEB_ORDER;
+    int bucketSize = DEFAULTBUCKETSIZE; // Pontos guardados em cada folha da árvore
+
     std::string genFilePath, inputFilePath;
     for (int i = 1; i < argc; i++)
     {
@@ -139,12 +189,58 @@ int main(int argc, char *argv[])
         else if (arg == "-t")
         {
             tFlag = true;
-            if (argc == 7)
+            if ((i + 1) < argc && argv[i + 1][0] != '-')
             {
                 std::string prop = argv[++i];
                 SMV::setMemToSwapRatio(std::stod(prop)); // Atualiza a razão com o valor fornecido
             }
         }
+        else if (arg == "-p" && (i + 1) < argc)
+        {
+            std::string politica = argv[++i];
+            ReplacementPolicyKind kind;
+            if (!parseReplacementPolicy(politica, kind))
+            {
+                std::cerr << "Política de substituição inválida: " << politica << std::endl;
+                return 1;
+            }
+            SMV::setReplacementPolicy(kind);
+        }
+        else if (arg == "-r" && (i + 1) < argc)
+        {
+            SMV::setTraceFile(argv[++i]); // Grava as referências a páginas para o smvreplay
+        }
+        else if (arg == "-o" && (i + 1) < argc)
+        {
+            std::string ordem = argv[++i];
+            reorderNodes = true;
+            if (ordem == "morton")
+            {
+                nodeOrder = MORTON_ORDER;
+            }
+            else if (ordem == "hilbert")
+            {
+                nodeOrder = HILBERT_ORDER;
+            }
+            else if (ordem == "veb")
+            {
+                nodeOrder = VEB_ORDER;
+            }
+            else
+            {
+                std::cerr << "Ordem inválida: " << ordem << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "-f" && (i + 1) < argc)
+        {
+            bucketSize = std::stoi(argv[++i]);
+            if (bucketSize < 0 || bucketSize > MAXBUCKETSIZE)
+            {
+                std::cerr << "Número de pontos por folha inválido: " << bucketSize << std::endl;
+                return 1;
+            }
+        }
         else
         {
             std::cerr << "Parâmetro inválido: " << arg << std::endl;
@@ -164,9 +260,14 @@ int main(int argc, char *argv[])
         iss >> numEnderecos;
     }
 
-    QuadTree quadTree(numEnderecos, Rectangle(Point(150000, 7500000), Point(7500000, 10000000)));
+    QuadTree quadTree(numEnderecos, Rectangle(Point(150000, 7500000), Point(7500000, 10000000)), bucketSize);
 
-    HashTable<std::string, AddressInfo> *estacoes = loadFile(genFile, numEnderecos, quadTree);
+    StationArena estacoes(numEnderecos);
+    HashTable<stationid_t, stationidx_t> *indice = loadFile(genFile, numEnderecos, quadTree, estacoes);
+    if (reorderNodes)
+    {
+        quadTree.reorder(nodeOrder);
+    }
 
     std::ifstream inputFile(inputFilePath);
     int numInputs;
@@ -185,27 +286,27 @@ int main(int argc, char *argv[])
     {
         std::cout << line << std::endl;
         char command = line[0];
-        std::istringstream iss(line.substr(1));
+        const char *args = line.c_str() + 1;
 
         if (command == 'C')
         {
-
-            double x, y;
-            int n;
-            iss >> x >> y >> n;
-            consultar(quadTree, *estacoes, x, y, n);
+            char *fim;
+            double x = strtod(args, &fim);
+            double y = strtod(fim, &fim);
+            int n = static_cast<int>(strtol(fim, &fim, 10));
+            consultar(quadTree, estacoes, x, y, n);
         }
         else if (command == 'A')
         {
-            std::string id;
-            iss >> id;
-            ativar(quadTree, *estacoes, numEnderecos, id);
+            std::string texto; // Identificador como escrito no evento
+            stationid_t id = lerId(args, texto);
+            ativar(quadTree, estacoes, *indice, numEnderecos, id, texto);
         }
         else if (command == 'D')
         {
-            std::string id;
-            iss >> id;
-            desativar(quadTree, *estacoes, numEnderecos, id);
+            std::string texto; // Identificador como escrito no evento
+            stationid_t id = lerId(args, texto);
+            desativar(quadTree, estacoes, *indice, numEnderecos, id, texto);
         }
     }
 
@@ -215,8 +316,7 @@ int main(int argc, char *argv[])
     }
 
     inputFile.close();
-    estacoes->~HashTable();
-    quadTree.~QuadTree();
+    indice->~HashTable();
 
     return 0;
 }
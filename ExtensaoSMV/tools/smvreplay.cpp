@@ -0,0 +1,241 @@
+/**
+ * @file smvreplay.cpp
+ * @brief Reproduz um traço de referências a páginas do SMV com todas as políticas de substituição.
+ *
+ * Para cada razão entre memória principal e secundária (o MEMTOSWAPRATIO do SMV), simula o traço com cada
+ * política de ReplacementPolicy.h e com a política ótima de Belady (OPT), que tira da memória a página cuja
+ * próxima referência está mais distante. Informa, para cada configuração, as faltas de página (cargas do
+ * disco), as saídas de páginas da memória e quantas delas tinham sido escritas desde a carga, ou seja,
+ * precisariam voltar ao disco. A simulação segue o SMV: todas as páginas começam no disco, e uma página sai
+ * antes de outra entrar quando páginas em memória + 1 > NUMPAGE * razão.
+ *
+ * Uso: ./smvreplay.out <arquivo_traco> [razões...]
+ * Sem razões, usa 0.1, 0.2, ..., 1.0. O traço é gravado pelo tp3.out com -t [razão] -r <arquivo_traco>.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "PageTrace.h"
+#include "ReplacementPolicy.h"
+
+#define NEVER 0x7fffffffffffffffL /* posição usada quando a página não é mais referenciada */
+
+/**
+ * @brief Política ótima de Belady, que conhece o traço inteiro.
+ *
+ * Cada chamada de access ou load corresponde à próxima referência do traço. Os candidatos ficam em um heap
+ * pela posição da próxima referência; entradas de páginas que já saíram ou foram referenciadas de novo são
+ * descartadas quando chegam ao topo.
+ */
+class OptimalPolicy : public ReplacementPolicy
+{
+public:
+    OptimalPolicy(int numPages, const std::vector<long> &nextUse)
+        : _nextUse(nextUse), _current(numPages, -1), _cursor(0)
+    {
+    }
+
+    void access(int page) override { touch(page); }
+
+    void load(int page) override { touch(page); }
+
+    int evict(int) override
+    {
+        while (!_heap.empty())
+        {
+            std::pair<long, int> top = _heap.top();
+            _heap.pop();
+            if (_current[top.second] == top.first)
+            {
+                _current[top.second] = -1;
+                return top.second;
+            }
+        }
+        return -1;
+    }
+
+private:
+    void touch(int page)
+    {
+        _current[page] = _nextUse[_cursor++];
+        _heap.push(std::make_pair(_current[page], page));
+    }
+
+    const std::vector<long> &_nextUse;          /**< Posição da próxima referência à mesma página */
+    std::vector<long> _current;                 /**< Próxima referência de cada página em memória, ou -1 */
+    std::priority_queue<std::pair<long, int>> _heap;
+    long _cursor;                               /**< Posição da referência atual no traço */
+};
+
+/**
+ * @brief Resultado da reprodução do traço com uma configuração.
+ */
+struct ReplayResult
+{
+    long faults = 0;     /**< Cargas de páginas do disco */
+    long evictions = 0;  /**< Páginas retiradas da memória */
+    long writebacks = 0; /**< Páginas retiradas que tinham sido escritas desde a carga */
+};
+
+/**
+ * @brief Reproduz o traço com uma política.
+ *
+ * @param records Registros do traço.
+ * @param numPages Número de páginas do SMV que gravou o traço.
+ * @param ratio Razão entre memória principal e secundária.
+ * @param policy A política, recém-criada.
+ */
+static ReplayResult replay(const std::vector<uint32_t> &records, int numPages, double ratio, ReplacementPolicy &policy)
+{
+    ReplayResult result;
+    std::vector<bool> resident(numPages, false), modified(numPages, false);
+    int pagesInMemory = 0;
+
+    for (uint32_t record : records)
+    {
+        int page = pageTracePage(record);
+        bool writing = pageTraceWrite(record);
+        if (resident[page])
+        {
+            policy.access(page);
+        }
+        else
+        {
+            result.faults++;
+            if (pagesInMemory + 1 > numPages * ratio)
+            {
+                int victim = policy.evict(page);
+                if (victim != -1)
+                {
+                    result.evictions++;
+                    result.writebacks += modified[victim];
+                    resident[victim] = false;
+                    pagesInMemory--;
+                }
+            }
+            resident[page] = true;
+            modified[page] = false;
+            pagesInMemory++;
+            policy.load(page);
+        }
+        if (writing)
+        {
+            modified[page] = true;
+            policy.modify(page);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Lê o traço, conferindo o cabeçalho e os índices das páginas.
+ */
+static bool readTrace(const char *path, PageTraceHeader &header, std::vector<uint32_t> &records)
+{
+    FILE *file = std::fopen(path, "rb");
+    if (!file)
+    {
+        std::cerr << "Não foi possível abrir o traço: " << path << std::endl;
+        return false;
+    }
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 && header.magic == PAGETRACEMAGIC && header.version == PAGETRACEVERSION;
+    if (!ok)
+    {
+        std::cerr << "Arquivo não é um traço do SMV: " << path << std::endl;
+    }
+    uint32_t buffer[4096];
+    size_t lidos;
+    while (ok && (lidos = std::fread(buffer, sizeof(uint32_t), 4096, file)) > 0)
+    {
+        for (size_t i = 0; i < lidos; i++)
+        {
+            if (pageTracePage(buffer[i]) >= static_cast<int>(header.numPages))
+            {
+                std::cerr << "Página fora do intervalo no traço: " << pageTracePage(buffer[i]) << std::endl;
+                ok = false;
+                break;
+            }
+            records.push_back(buffer[i]);
+        }
+    }
+    std::fclose(file);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Uso: ./smvreplay.out <arquivo_traco> [razões...]" << std::endl;
+        return 1;
+    }
+
+    PageTraceHeader header;
+    std::vector<uint32_t> records;
+    if (!readTrace(argv[1], header, records))
+    {
+        return 1;
+    }
+    int numPages = header.numPages;
+
+    std::vector<double> ratios;
+    for (int i = 2; i < argc; i++)
+    {
+        ratios.push_back(std::atof(argv[i]));
+    }
+    if (ratios.empty())
+    {
+        for (int i = 1; i <= 10; i++)
+        {
+            ratios.push_back(i / 10.0);
+        }
+    }
+
+    // Posição da próxima referência à mesma página, calculada de trás para frente, para a política ótima
+    std::vector<long> nextUse(records.size());
+    std::vector<long> seen(numPages, NEVER);
+    for (long i = static_cast<long>(records.size()) - 1; i >= 0; i--)
+    {
+        int page = pageTracePage(records[i]);
+        nextUse[i] = seen[page];
+        seen[page] = i;
+    }
+
+    std::cout << "traço: " << records.size() << " referências, " << numPages << " páginas de " << header.pageSize << " bytes" << std::endl;
+    // Os rótulos acentuados ocupam mais bytes que colunas, por isso o cabeçalho não usa setw
+    std::cout << "razão   política           faltas    saídas   gravações" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    for (double ratio : ratios)
+    {
+        int capacity = std::max(1, static_cast<int>(numPages * ratio));
+        for (int k = 0; k <= NUMREPLACEMENTPOLICIES; k++)
+        {
+            ReplacementPolicy *policy;
+            const char *name;
+            if (k < NUMREPLACEMENTPOLICIES)
+            {
+                ReplacementPolicyKind kind = static_cast<ReplacementPolicyKind>(k);
+                policy = createReplacementPolicy(kind, numPages, capacity);
+                name = replacementPolicyName(kind);
+            }
+            else
+            {
+                policy = new OptimalPolicy(numPages, nextUse);
+                name = "opt";
+            }
+            ReplayResult result = replay(records, numPages, ratio, *policy);
+            delete policy;
+
+            std::cout << std::left << std::setw(8) << ratio << std::setw(15) << name << std::right
+                      << std::setw(10) << result.faults << std::setw(10) << result.evictions << std::setw(12) << result.writebacks << std::endl;
+        }
+    }
+    return 0;
+}
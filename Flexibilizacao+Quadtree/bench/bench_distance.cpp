@@ -0,0 +1,126 @@
+/**
+ * @file bench_distance.cpp
+ * @brief Microbenchmark do cálculo vetorizado de distâncias e da busca exaustiva que o utiliza.
+ *
+ * Mede, para cada implementação suportada de squaredDistances, o tempo por ponto sobre todas as estações e o
+ * tempo por consulta da busca exaustiva (StationArena::KNNSearch). Para comparação, mede também a busca na
+ * QuadTree (HeuristicKNNSearch) sobre os mesmos pontos. Confere que todas as buscas devolvem as mesmas
+ * distâncias.
+ *
+ * Uso: ./bench_distance.out [N] [consultas] [K]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "QuadTree.h"
+#include "StationArena.h"
+#include "DistanceKernel.h"
+
+using benchclock = std::chrono::steady_clock;
+
+static double nsPerOp(benchclock::time_point start, benchclock::time_point end, double ops)
+{
+    return std::chrono::duration<double, std::nano>(end - start).count() / ops;
+}
+
+/**
+ * @brief Soma as distâncias ao quadrado dos vizinhos encontrados, para conferir que as buscas concordam.
+ */
+static double somaDistancias(BoundedPriorityQueue<Pair<double, Point>> &pq)
+{
+    double soma = 0;
+    pq.sort(); // A soma em ordem crescente não depende da ordem em que os vizinhos foram encontrados
+    for (const Pair<double, Point> &vizinho : pq)
+    {
+        soma += vizinho.getFirst();
+    }
+    return soma;
+}
+
+int main(int argc, char *argv[])
+{
+    long numPoints = argc > 1 ? std::atol(argv[1]) : 100000;
+    long numQueries = argc > 2 ? std::atol(argv[2]) : 200;
+    int K = argc > 3 ? std::atoi(argv[3]) : 10;
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> xs(590000, 620000);
+    std::uniform_real_distribution<double> ys(7780000, 7820000);
+
+    StationArena estacoes(numPoints);
+    for (long i = 0; i < numPoints; i++)
+    {
+        estacoes.add(xs(gen), ys(gen), AddressInfo());
+    }
+
+    std::vector<Point> consultas;
+    for (long i = 0; i < numQueries; i++)
+    {
+        consultas.push_back(Point(xs(gen), ys(gen)));
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+
+    // Referência: busca na árvore
+    QuadTree quadTree(numPoints + 1, Rectangle(Point(150000, 7500000), Point(7500000, 10000000)));
+    std::vector<Point *> pontos;
+    for (long i = 0; i < numPoints; i++)
+    {
+        pontos.push_back(&estacoes.point(i));
+    }
+    quadTree.build(pontos);
+
+    std::vector<double> referencia;
+    benchclock::time_point start = benchclock::now();
+    for (const Point &p : consultas)
+    {
+        BoundedPriorityQueue<Pair<double, Point>> pq(K);
+        quadTree.HeuristicKNNSearch(p, K, pq);
+        referencia.push_back(somaDistancias(pq));
+    }
+    benchclock::time_point end = benchclock::now();
+    std::cout << "quadtree knn (K=" << K << "): " << nsPerOp(start, end, numQueries) << " ns/consulta" << std::endl;
+
+    std::vector<double> xsContiguos(numPoints), ysContiguos(numPoints), distancias(numPoints);
+    for (long i = 0; i < numPoints; i++)
+    {
+        xsContiguos[i] = estacoes.point(i).getX();
+        ysContiguos[i] = estacoes.point(i).getY();
+    }
+
+    const DistanceKernel kernels[] = {SCALAR_KERNEL, SSE2_KERNEL, AVX2_KERNEL};
+    for (DistanceKernel kernel : kernels)
+    {
+        if (!setDistanceKernel(kernel))
+        {
+            std::cout << distanceKernelName(kernel) << ": não suportado" << std::endl;
+            continue;
+        }
+
+        start = benchclock::now();
+        for (const Point &p : consultas)
+        {
+            squaredDistances(xsContiguos.data(), ysContiguos.data(), numPoints, p.getX(), p.getY(), distancias.data());
+        }
+        end = benchclock::now();
+        std::cout << distanceKernelName(kernel) << " distancias: " << nsPerOp(start, end, static_cast<double>(numQueries) * numPoints) << " ns/ponto";
+
+        long divergentes = 0;
+        start = benchclock::now();
+        for (long i = 0; i < numQueries; i++)
+        {
+            BoundedPriorityQueue<Pair<double, Point>> pq(K);
+            estacoes.KNNSearch(consultas[i], K, pq);
+            divergentes += somaDistancias(pq) != referencia[i];
+        }
+        end = benchclock::now();
+        std::cout << ", busca exaustiva: " << nsPerOp(start, end, numQueries) << " ns/consulta (" << divergentes << " divergentes)" << std::endl;
+    }
+
+    setDistanceKernel(bestDistanceKernel());
+    return 0;
+}
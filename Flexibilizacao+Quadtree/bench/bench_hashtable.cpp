@@ -0,0 +1,161 @@
+/**
+ * @file bench_hashtable.cpp
+ * @brief Microbenchmark da HashTable usada para localizar as estações pelo identificador.
+ *
+ * Gera N identificadores no formato da base (11 dígitos e uma letra, com prefixos numéricos longos em comum)
+ * e mede o tempo médio por operação de insert, de search de chaves presentes e de search de chaves ausentes,
+ * tanto com as chaves codificadas em stationid_t, como em main.cpp, quanto com as chaves de texto.
+ * Como em main.cpp, a tabela é criada com o número de estações; com um tamanho inicial menor, o custo de
+ * crescimento entra na medida de insert. Ao final, imprime o histograma das distâncias de sondagem.
+ *
+ * Com -b, os identificadores são lidos da primeira coluna de um arquivo de base (no formato lido por
+ * main.cpp) e apenas o histograma é impresso, para verificar a distribuição das chaves reais.
+ *
+ * Uso: ./bench_hashtable.out [N] [tamanho_inicial]
+ *      ./bench_hashtable.out -b arquivo.base
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "HashTable.h"
+
+using benchclock = std::chrono::steady_clock;
+
+static double nsPerOp(benchclock::time_point start, benchclock::time_point end, long ops)
+{
+    return std::chrono::duration<double, std::nano>(end - start).count() / ops;
+}
+
+/**
+ * @brief Gera identificadores como os da base: código do logradouro, número do imóvel e uma letra.
+ */
+static std::vector<std::string> gerarIds(long n, std::mt19937 &gen)
+{
+    std::uniform_int_distribution<int> logradouro(0, 99999);
+    std::uniform_int_distribution<int> numero(0, 99999);
+    std::uniform_int_distribution<int> letra(0, 3);
+
+    std::vector<std::string> ids;
+    ids.reserve(n);
+    char buffer[16];
+    for (long i = 0; i < n; i++)
+    {
+        snprintf(buffer, sizeof(buffer), "%06d%05d%c", logradouro(gen), numero(gen), "ABCD"[letra(gen)]);
+        ids.push_back(buffer);
+    }
+    return ids;
+}
+
+/**
+ * @brief Lê os identificadores (primeira coluna) de um arquivo de base, ignorando a linha com a quantidade.
+ */
+static std::vector<std::string> lerIds(const char *caminho)
+{
+    std::vector<std::string> ids;
+    std::ifstream arquivo(caminho);
+    std::string linha;
+    std::getline(arquivo, linha);
+    while (std::getline(arquivo, linha))
+    {
+        size_t fim = linha.find(';');
+        if (fim != std::string::npos)
+        {
+            ids.push_back(linha.substr(0, fim));
+        }
+    }
+    return ids;
+}
+
+/**
+ * @brief Codifica os identificadores como em main.cpp.
+ */
+static std::vector<stationid_t> codificar(const std::vector<std::string> &ids)
+{
+    std::vector<stationid_t> codificados;
+    codificados.reserve(ids.size());
+    for (const std::string &id : ids)
+    {
+        codificados.push_back(encodeStationId(id.c_str()));
+    }
+    return codificados;
+}
+
+/**
+ * @brief Mede insert, search de chaves presentes e search de chaves ausentes em uma tabela com chaves do tipo K.
+ */
+template <typename K>
+static void medir(const char *nome, const std::vector<K> &ids, const std::vector<K> &ausentes, int tamanhoInicial)
+{
+    long n = ids.size();
+    std::cout << "== " << nome << std::endl;
+
+    HashTable<K, stationidx_t> tabela(tamanhoInicial);
+    benchclock::time_point start = benchclock::now();
+    for (long i = 0; i < n; i++)
+    {
+        tabela.insert(ids[i], static_cast<stationidx_t>(i));
+    }
+    benchclock::time_point end = benchclock::now();
+    std::cout << "insert: " << nsPerOp(start, end, n) << " ns/op" << std::endl;
+
+    long encontrados = 0;
+    start = benchclock::now();
+    for (long i = 0; i < n; i++)
+    {
+        encontrados += tabela.search(ids[i]) != nullptr;
+    }
+    end = benchclock::now();
+    std::cout << "search (presentes): " << nsPerOp(start, end, n) << " ns/op (" << encontrados << " encontrados)" << std::endl;
+
+    encontrados = 0;
+    start = benchclock::now();
+    for (long i = 0; i < n; i++)
+    {
+        encontrados += tabela.search(ausentes[i]) != nullptr;
+    }
+    end = benchclock::now();
+    std::cout << "search (ausentes): " << nsPerOp(start, end, n) << " ns/op (" << encontrados << " encontrados)" << std::endl;
+
+    tabela.printStats(std::cout);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 2 && std::strcmp(argv[1], "-b") == 0)
+    {
+        std::vector<stationid_t> ids = codificar(lerIds(argv[2]));
+        HashTable<stationid_t, stationidx_t> tabela(ids.size());
+        for (size_t i = 0; i < ids.size(); i++)
+        {
+            tabela.insert(ids[i], static_cast<stationidx_t>(i));
+        }
+        tabela.printStats(std::cout);
+        return 0;
+    }
+
+    long n = argc > 1 ? std::atol(argv[1]) : 1000000;
+    int tamanhoInicial = argc > 2 ? std::atoi(argv[2]) : static_cast<int>(n);
+
+    std::mt19937 gen(42);
+    std::vector<std::string> ids = gerarIds(n, gen);
+    std::vector<std::string> ausentes = gerarIds(n, gen);
+    for (std::string &id : ausentes)
+    {
+        id[11] = 'Z'; // Nenhum identificador gerado termina em Z
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+
+    medir("chaves codificadas (stationid_t)", codificar(ids), codificar(ausentes), tamanhoInicial);
+    medir("chaves de texto (std::string)", ids, ausentes, tamanhoInicial);
+
+    return 0;
+}
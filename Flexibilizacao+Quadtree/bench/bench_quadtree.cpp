@@ -0,0 +1,111 @@
+/**
+ * @file bench_quadtree.cpp
+ * @brief Microbenchmark das operações de percurso da QuadTree.
+ *
+ * Constrói uma QuadTree com N pontos aleatórios por insert e outra por build, e mede em cada uma o tempo
+ * médio por operação de search e HeuristicKNNSearch. Como cada operação percorre a árvore nó a nó, o tempo
+ * por operação acompanha diretamente o custo de acesso a cada nó e a altura da árvore. O número de pontos
+ * por folha (B) permite comparar folhas com baldes à árvore de um ponto por nó (B = 0). Por fim, remove e
+ * reinsere cada ponto da árvore construída por build, conferindo que o número de nós em uso não cresce.
+ *
+ * Uso: ./bench_quadtree.out [N] [consultas] [K] [B]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "QuadTree.h"
+
+using benchclock = std::chrono::steady_clock;
+
+static double nsPerOp(benchclock::time_point start, benchclock::time_point end, long ops)
+{
+    return std::chrono::duration<double, std::nano>(end - start).count() / ops;
+}
+
+/**
+ * @brief Mede search de todos os pontos e numQueries consultas KNN com pontos sorteados por uma semente fixa.
+ */
+static void runQueries(const char *label, QuadTree &quadTree, std::vector<Point> &points, long numQueries, int K)
+{
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> xs(590000, 620000);
+    std::uniform_real_distribution<double> ys(7780000, 7820000);
+
+    long found = 0;
+    benchclock::time_point start = benchclock::now();
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        found += quadTree.search(points[i]) != INVALIDADDR;
+    }
+    benchclock::time_point end = benchclock::now();
+    std::cout << label << " search: " << nsPerOp(start, end, points.size()) << " ns/op (" << found << " encontrados)" << std::endl;
+
+    start = benchclock::now();
+    for (long i = 0; i < numQueries; i++)
+    {
+        BoundedPriorityQueue<Pair<double, Point>> pq(K);
+        quadTree.HeuristicKNNSearch(Point(xs(gen), ys(gen)), K, pq);
+    }
+    end = benchclock::now();
+    std::cout << label << " knn (K=" << K << "): " << nsPerOp(start, end, numQueries) << " ns/op" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    long numPoints = argc > 1 ? std::atol(argv[1]) : 100000;
+    long numQueries = argc > 2 ? std::atol(argv[2]) : 10000;
+    int K = argc > 3 ? std::atoi(argv[3]) : 10;
+    int bucketSize = argc > 4 ? std::atoi(argv[4]) : DEFAULTBUCKETSIZE;
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> xs(590000, 620000);
+    std::uniform_real_distribution<double> ys(7780000, 7820000);
+
+    std::vector<Point> points;
+    points.reserve(numPoints);
+    for (long i = 0; i < numPoints; i++)
+    {
+        points.push_back(Point(xs(gen), ys(gen), i));
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+
+    QuadTree inserted(numPoints + 1, Rectangle(Point(150000, 7500000), Point(7500000, 10000000)), bucketSize);
+    benchclock::time_point start = benchclock::now();
+    for (long i = 0; i < numPoints; i++)
+    {
+        inserted.insert(points[i]);
+    }
+    benchclock::time_point end = benchclock::now();
+    std::cout << "insert: " << nsPerOp(start, end, numPoints) << " ns/op" << std::endl;
+    runQueries("insert", inserted, points, numQueries, K);
+
+    QuadTree built(numPoints + 1, Rectangle(Point(150000, 7500000), Point(7500000, 10000000)), bucketSize);
+    std::vector<Point *> pointers;
+    for (Point &p : points)
+    {
+        pointers.push_back(&p);
+    }
+    start = benchclock::now();
+    built.build(pointers);
+    end = benchclock::now();
+    std::cout << "build: " << nsPerOp(start, end, numPoints) << " ns/op" << std::endl;
+    runQueries("build", built, points, numQueries, K);
+
+    long nodesBefore = built.nodeCount();
+    start = benchclock::now();
+    for (long i = 0; i < numPoints; i++)
+    {
+        built.remove(points[i]);
+        built.insert(points[i]);
+    }
+    end = benchclock::now();
+    std::cout << "remove+insert: " << nsPerOp(start, end, numPoints) << " ns/op (nós em uso: " << nodesBefore << " -> " << built.nodeCount() << ")" << std::endl;
+    runQueries("churn", built, points, numQueries, K);
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file bench_topk.cpp
+ * @brief Microbenchmark da seleção dos K menores elementos de uma sequência, como no resultado da busca KNN.
+ *
+ * Para cada K, passa a mesma sequência de distâncias por duas filas e extrai os K menores em
+ * ordem crescente:
+ *  - PriorityQueue: push até encher, depois pop seguido de push para cada elemento melhor que o topo, e
+ *    toggleMode antes da extração, como a busca KNN fazia;
+ *  - BoundedPriorityQueue: push até encher, depois replaceTop, e sort para ler o resultado no próprio array.
+ * O tempo é dado por elemento da sequência, incluindo a extração. São usadas duas sequências: distâncias
+ * aleatórias, em que poucos elementos entram depois que a fila enche, e distâncias decrescentes, em que todo
+ * elemento substitui o topo (o pior caso).
+ *
+ * Uso: ./bench_topk.out [tamanho_da_sequencia] [repeticoes]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "PriorityQueue.h"
+#include "BoundedPriorityQueue.h"
+
+using benchclock = std::chrono::steady_clock;
+
+/**
+ * @brief Seleciona os K menores com a PriorityQueue e devolve a soma das distâncias extraídas, para conferência.
+ */
+static double selecionarPriorityQueue(const std::vector<Pair<double, int>> &sequencia, int K)
+{
+    PriorityQueue<Pair<double, int>> pq(K);
+    for (const Pair<double, int> &elemento : sequencia)
+    {
+        if (pq.size() < K)
+        {
+            pq.push(elemento);
+        }
+        else if (elemento.getFirst() < pq.top().getFirst())
+        {
+            pq.pop();
+            pq.push(elemento);
+        }
+    }
+
+    double soma = 0;
+    pq.toggleMode();
+    while (!pq.empty())
+    {
+        soma += pq.top().getFirst();
+        pq.pop();
+    }
+    return soma;
+}
+
+/**
+ * @brief Seleciona os K menores com a BoundedPriorityQueue e devolve a soma das distâncias extraídas, para conferência.
+ */
+static double selecionarBounded(const std::vector<Pair<double, int>> &sequencia, int K)
+{
+    BoundedPriorityQueue<Pair<double, int>> pq(K);
+    for (const Pair<double, int> &elemento : sequencia)
+    {
+        if (pq.size() < K)
+        {
+            pq.push(elemento);
+        }
+        else if (elemento.getFirst() < pq.top().getFirst())
+        {
+            pq.replaceTop(elemento);
+        }
+    }
+
+    double soma = 0;
+    pq.sort();
+    for (const Pair<double, int> &elemento : pq)
+    {
+        soma += elemento.getFirst();
+    }
+    return soma;
+}
+
+/**
+ * @brief Executa uma seleção repetidas vezes e devolve o tempo médio por elemento da sequência.
+ */
+static double medir(double (*selecionar)(const std::vector<Pair<double, int>> &, int),
+                    const std::vector<Pair<double, int>> &sequencia, int K, int repeticoes, double &soma)
+{
+    benchclock::time_point start = benchclock::now();
+    for (int r = 0; r < repeticoes; r++)
+    {
+        soma = selecionar(sequencia, K);
+    }
+    benchclock::time_point end = benchclock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / (static_cast<double>(sequencia.size()) * repeticoes);
+}
+
+int main(int argc, char *argv[])
+{
+    long n = argc > 1 ? std::atol(argv[1]) : 100000;
+    int repeticoes = argc > 2 ? std::atoi(argv[2]) : 10;
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> distancia(0, 20000);
+    std::vector<Pair<double, int>> aleatoria, decrescente;
+    aleatoria.reserve(n);
+    decrescente.reserve(n);
+    for (long i = 0; i < n; i++)
+    {
+        aleatoria.push_back(Pair<double, int>(distancia(gen), static_cast<int>(i)));
+        decrescente.push_back(Pair<double, int>(static_cast<double>(n - i), static_cast<int>(i)));
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "ns por elemento\taleatoria\t\tdecrescente" << std::endl;
+    std::cout << "K\tPriorityQueue\tBounded\t\tPriorityQueue\tBounded" << std::endl;
+
+    const int valoresK[] = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+    for (int K : valoresK)
+    {
+        std::cout << K;
+        for (const std::vector<Pair<double, int>> *sequencia : {&aleatoria, &decrescente})
+        {
+            double somaAntiga, somaNova;
+            double antiga = medir(selecionarPriorityQueue, *sequencia, K, repeticoes, somaAntiga);
+            double nova = medir(selecionarBounded, *sequencia, K, repeticoes, somaNova);
+            std::cout << "\t" << antiga << "\t\t" << nova << (somaAntiga == somaNova ? "\t" : "(!)\t");
+        }
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
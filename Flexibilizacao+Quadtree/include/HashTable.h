@@ -3,37 +3,93 @@
 
 #include "Pair.h"
 #include "Point.h"
+#include "StationId.h"
 #include <string>
-#include "Address.h"
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 
+/**
+ * @brief Mistura final do hash (finalizador do MurmurHash3), que espalha cada bit da entrada por todos os bits da saída.
+ *
+ * Garante que os bits baixos, usados para indexar a tabela, dependam de todos os caracteres da chave.
+ *
+ * @param hash O valor a ser misturado.
+ * @return O valor misturado.
+ */
+inline uint64_t hashMix(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
 /**
  * @brief Função de hash que converte uma string em um valor numérico.
  *
- * Esta função aplica uma combinação de multiplicação por um número primo 
- * e a posição de cada caractere na string para gerar um valor de hash.
+ * A chave é consumida uma palavra de 8 bytes por vez, e o restante em um bloco de 4 bytes e bytes avulsos,
+ * de modo que um identificador de estação (11 dígitos e uma letra) custa apenas uma palavra e um bloco. A cada
+ * passo a metade alta é dobrada sobre a baixa, já que a multiplicação só propaga diferenças para os bits altos;
+ * como os identificadores compartilham prefixos longos, o resultado ainda passa pelo hashMix.
  *
  * @param key A chave do tipo string que será convertida em hash.
- * @param tableSize O tamanho da tabela hash para ajustar o valor gerado.
- * @return O valor de hash ajustado para o tamanho da tabela.
+ * @return O valor de hash completo; a tabela o reduz ao seu tamanho.
  */
-unsigned int hashFunction(const std::string &key, int tableSize)
+inline uint64_t hashFunction(const std::string &key)
 {
-    unsigned long long hash = 0;
-    unsigned long long prime = 53; // Número primo usado como base
-    int keyLength = key.length();
+    const uint64_t multiplicador = 0x9e3779b97f4a7c15ULL; // Constante de Fibonacci (2^64 / razão áurea)
+    const char *c = key.data();
+    size_t restante = key.length();
+    uint64_t hash = restante * multiplicador;
 
-    for (int i = 0; i < keyLength; i++)
+    while (restante >= 8)
     {
-        hash = hash * prime + static_cast<unsigned long long>(key[i]) * (i + 1);
+        uint64_t palavra;
+        std::memcpy(&palavra, c, 8);
+        hash = (hash ^ palavra) * multiplicador;
+        hash ^= hash >> 32;
+        c += 8;
+        restante -= 8;
+    }
+    if (restante >= 4)
+    {
+        uint32_t bloco;
+        std::memcpy(&bloco, c, 4);
+        hash = (hash ^ bloco) * multiplicador;
+        hash ^= hash >> 32;
+        c += 4;
+        restante -= 4;
+    }
+    while (restante > 0)
+    {
+        hash = (hash ^ static_cast<unsigned char>(*c)) * multiplicador;
+        hash ^= hash >> 32;
+        c++;
+        restante--;
     }
 
-    return hash % tableSize;
+    return hashMix(hash);
+}
+
+/**
+ * @brief Função de hash de um identificador de estação codificado (ou outra chave inteira de 64 bits).
+ *
+ * @param key A chave a ser convertida em hash.
+ * @return O valor de hash completo; a tabela o reduz ao seu tamanho.
+ */
+inline uint64_t hashFunction(uint64_t key)
+{
+    return hashMix(key);
 }
 
 /**
  * @class HashNode
- * @brief Estrutura de nó para armazenar pares chave-valor na tabela hash.
+ * @brief Representa um par chave-valor armazenado na tabela hash.
  *
  * @tparam K Tipo da chave.
  * @tparam V Tipo do valor.
@@ -43,22 +99,37 @@ struct HashNode
 {
     K key;  ///< Chave do tipo genérico K.
     V value;  ///< Valor associado à chave do tipo genérico V.
-    HashNode *next;  ///< Ponteiro para o próximo nó em caso de colisão.
 
     /**
-     * @brief Construtor da estrutura HashNode.
+     * @brief Construtor do nó da tabela hash.
      *
-     * @param k A chave a ser armazenada.
-     * @param v O valor a ser armazenado.
+     * @param k A chave do nó.
+     * @param v O valor associado à chave.
      */
-    HashNode(K k, V v) : key(k), value(v), next(nullptr) {}
+    HashNode(const K &k, const V &v) : key(k), value(v) {}
+};
+
+/**
+ * @class HashSlot
+ * @brief Posição da tabela de sondagem: o hash de uma chave e o índice do nó que a guarda.
+ */
+struct HashSlot
+{
+    uint32_t hash;  ///< Hash da chave, comparado antes da chave para descartar colisões sem acessar o nó.
+    int32_t node;  ///< Índice do nó no vetor de nós.
+    int32_t dist;  ///< Distância entre esta posição e a posição ideal da chave, ou -1 se a posição estiver vazia.
 };
 
 /**
  * @class HashTable
- * @brief Implementação de uma tabela hash usando listas encadeadas para colisões.
+ * @brief Implementação de uma tabela hash com endereçamento aberto (Robin Hood).
  *
- * Esta classe permite operações eficientes de inserção e busca de pares chave-valor.
+ * Os pares chave-valor ficam contíguos em um vetor, na ordem de inserção. As colisões são resolvidas por
+ * sondagem linear em um vetor separado de posições pequenas, que guardam apenas o hash e o índice do nó, de
+ * modo que a sondagem percorre poucas linhas de cache e só acessa um nó quando o hash coincide. Na inserção,
+ * uma chave que já está mais longe de sua posição ideal toma o lugar de uma que está mais perto, o que mantém
+ * as sequências de sondagem curtas e permite encerrar a busca de uma chave ausente assim que ela estaria mais
+ * longe que a chave encontrada. O vetor de posições dobra de tamanho quando a ocupação passaria de 7/8.
  *
  * @tparam K Tipo da chave.
  * @tparam V Tipo do valor.
@@ -67,49 +138,102 @@ template <typename K, typename V>
 class HashTable
 {
 private:
-    HashNode<K, V *> **table;  ///< Ponteiro para um array de ponteiros de nós.
-    int tableSize;  ///< Tamanho da tabela hash.
+    std::vector<HashNode<K, V>> nodes;  ///< Pares chave-valor, na ordem de inserção.
+    std::vector<HashSlot> slots;  ///< Posições da tabela de sondagem.
+    int capacity;  ///< Número de posições, sempre uma potência de dois.
+    uint32_t mask;  ///< capacity - 1, aplicado ao hash no lugar do módulo.
 
-public:
     /**
-     * @brief Construtor da tabela hash.
+     * @brief Posiciona uma chave que ainda não está na tabela, deslocando as mais próximas de suas posições ideais.
      *
-     * Inicializa a tabela hash com o tamanho especificado, alocando memória
-     * e definindo todos os ponteiros como nulos.
+     * @param entry A posição a ser ocupada, com dist igual a 0.
+     */
+    void place(HashSlot entry)
+    {
+        HashSlot *table = slots.data();
+        uint32_t pos = entry.hash & mask;
+        while (table[pos].dist >= 0)
+        {
+            if (table[pos].dist < entry.dist)
+            {
+                std::swap(table[pos], entry);  ///< A chave mais distante fica com a posição e a outra segue adiante.
+            }
+            pos = (pos + 1) & mask;
+            entry.dist++;
+        }
+        table[pos] = entry;
+    }
+
+    /**
+     * @brief Recria a tabela de sondagem com um novo número de posições, usando os hashes guardados.
      *
-     * @param size Tamanho da tabela hash.
+     * @param newCapacity O novo número de posições.
      */
-    HashTable(int size) : tableSize(size)
+    void grow(int newCapacity)
     {
-        table = new HashNode<K, V *> *[tableSize];
-        for (int i = 0; i < tableSize; i++)
+        std::vector<HashSlot> old(newCapacity, HashSlot{0, -1, -1});
+        old.swap(slots);
+        capacity = newCapacity;
+        mask = newCapacity - 1;
+        for (const HashSlot &entry : old)
         {
-            table[i] = nullptr;
+            if (entry.dist >= 0)
+            {
+                place(HashSlot{entry.hash, entry.node, 0});
+            }
         }
     }
 
     /**
-     * @brief Destrutor da tabela hash.
+     * @brief Procura uma chave cujo hash já foi calculado.
      *
-     * Libera a memória alocada para a tabela hash e para todos os nós armazenados na tabela.
+     * @param key A chave procurada.
+     * @param hash O hash da chave.
+     * @return Ponteiro para o valor, ou nullptr se a chave não estiver na tabela.
      */
-    ~HashTable()
+    V *find(const K &key, uint32_t hash)
     {
-        for (int i = 0; i < tableSize; i++)
+        const HashSlot *table = slots.data();
+        uint32_t pos = hash & mask;
+        // Uma posição vazia (dist -1) ou com chave mais próxima de sua posição ideal encerra a busca
+        for (int dist = 0; table[pos].dist >= dist; dist++)
         {
-            HashNode<K, V *> *entry = table[i];
-            while (entry != nullptr)
+            if (table[pos].hash == hash && nodes[table[pos].node].key == key)
             {
-                HashNode<K, V *> *prev = entry;
-                entry = entry->next;
-                delete prev->value;  ///< Libera o valor apontado pelo nó.
-                delete prev;  ///< Libera o nó em si.
+                return &nodes[table[pos].node].value;
             }
-            table[i] = nullptr;
+            pos = (pos + 1) & mask;
         }
-        delete[] table;  ///< Libera o array de ponteiros.
+        return nullptr;
     }
 
+public:
+    /**
+     * @brief Construtor da tabela hash.
+     *
+     * Reserva espaço para o número de chaves esperado sem que a tabela precise crescer: o número de
+     * posições é a menor potência de dois que o comporta com ocupação de até 7/8.
+     *
+     * @param size Número de chaves esperado.
+     */
+    HashTable(int size) : capacity(8)
+    {
+        while (static_cast<long>(capacity) * 7 < static_cast<long>(size) * 8)
+        {
+            capacity *= 2;
+        }
+        mask = capacity - 1;
+        nodes.reserve(size);
+        slots.assign(capacity, HashSlot{0, -1, -1});
+    }
+
+    /**
+     * @brief Destrutor da tabela hash.
+     *
+     * Os nós e as posições são liberados junto com os vetores que os guardam.
+     */
+    ~HashTable() {}
+
     /**
      * @brief Insere um par chave-valor na tabela hash.
      *
@@ -118,67 +242,86 @@ public:
      * @param key A chave a ser inserida na tabela.
      * @param value O valor associado à chave.
      */
-    void insert(const K &key, V *value)
+    void insert(const K &key, const V &value)
     {
-        int hashValue = hashFunction(key, tableSize);  ///< Calcula o valor de hash.
-        HashNode<K, V *> *prev = nullptr;
-        HashNode<K, V *> *entry = table[hashValue];
+        uint32_t hash = static_cast<uint32_t>(hashFunction(key));  ///< Calcula o valor de hash.
 
-        // Percorre a lista encadeada na posição de hash até encontrar a chave ou o final da lista.
-        while (entry != nullptr && entry->key != key)
+        V *existente = find(key, hash);
+        if (existente != nullptr)
         {
-            prev = entry;
-            entry = entry->next;
+            *existente = value;  ///< Se a chave já existir, atualiza o valor.
+            return;
         }
 
-        if (entry == nullptr)
+        if (static_cast<long>(nodes.size() + 1) * 8 > static_cast<long>(capacity) * 7)
         {
-            // Se a chave não existir, cria um novo nó.
-            entry = new HashNode<K, V *>(key, value);
-            if (prev == nullptr)
-            {
-                table[hashValue] = entry;  ///< Insere o nó na tabela.
-            }
-            else
-            {
-                prev->next = entry;  ///< Insere o nó na lista encadeada.
-            }
-        }
-        else
-        {
-            // Se a chave já existir, atualiza o valor.
-            entry->value = value;
+            grow(capacity * 2);
         }
+
+        nodes.emplace_back(key, value);
+        place(HashSlot{hash, static_cast<int32_t>(nodes.size() - 1), 0});
     }
 
     /**
      * @brief Busca uma chave na tabela hash e retorna o valor associado a ela.
      *
+     * O ponteiro deixa de ser válido na próxima inserção, que pode realocar os nós.
+     *
      * @param key A chave a ser buscada na tabela.
-     * @return O valor associado à chave, ou nullptr se a chave não for encontrada.
+     * @return Ponteiro para o valor associado à chave, ou nullptr se a chave não for encontrada.
      */
     V *search(const K &key)
     {
-        int hashValue = hashFunction(key, tableSize);  ///< Calcula o valor de hash.
-        HashNode<K, V *> *entry = table[hashValue];
+        return find(key, static_cast<uint32_t>(hashFunction(key)));
+    }
+
+    /**
+     * @brief Retorna o número de chaves armazenadas.
+     *
+     * @return O número de chaves.
+     */
+    int size() const
+    {
+        return nodes.size();
+    }
 
-        // Percorre a lista encadeada na posição de hash.
-        while (entry != nullptr)
+    /**
+     * @brief Imprime a ocupação da tabela e o histograma das distâncias de sondagem.
+     *
+     * A distância de uma chave é o número de posições entre a posição ideal e a que ela ocupa, ou seja, o
+     * número de colisões enfrentadas ao buscá-la; o histograma permite verificar a distribuição das chaves
+     * de uma base real.
+     *
+     * @param out O fluxo de saída onde o relatório será impresso.
+     */
+    void printStats(std::ostream &out) const
+    {
+        std::vector<long> histograma;
+        long soma = 0;
+        for (const HashSlot &slot : slots)
         {
-            // Se encontrar a chave, retorna o valor associado.
-            if (entry->key == key)
+            if (slot.dist >= 0)
             {
-                return entry->value;
+                if (slot.dist >= static_cast<int>(histograma.size()))
+                {
+                    histograma.resize(slot.dist + 1, 0);
+                }
+                histograma[slot.dist]++;
+                soma += slot.dist;
             }
-
-            entry = entry->next;  ///< Avança para o próximo nó.
         }
 
-        return nullptr;  ///< Retorna nullptr se a chave não for encontrada.
+        long total = nodes.size();
+        out << "chaves: " << total << " posicoes: " << capacity << " ocupacao: " << (capacity ? 100.0 * total / capacity : 0) << "%" << std::endl;
+        out << "distancia media: " << (total ? static_cast<double>(soma) / total : 0) << " maxima: " << (histograma.empty() ? 0 : histograma.size() - 1) << std::endl;
+        for (size_t dist = 0; dist < histograma.size(); dist++)
+        {
+            out << dist << "\t" << histograma[dist] << "\t" << 100.0 * histograma[dist] / total << "%" << std::endl;
+        }
     }
 };
 
-// Instanciação da classe HashTable para o tipo específico de chave e valor.
-template class HashTable<std::string, AddressInfo>;
+// Instanciação da classe HashTable para o índice das estações por identificador.
+template class HashTable<stationid_t, stationidx_t>;
 
-#endif // HASHTABLE_H
\ No newline at end of file
+#endif // HASHTABLE_H
@@ -2,11 +2,16 @@
 #define POINT_H
 
 #include <cmath>
-#include <string>
+#include <cstdint>
+
+// Índice de uma estação no StationArena
+using stationidx_t = uint32_t;
+
+#define INVALIDSTATION UINT32_MAX // Índice usado por pontos que não pertencem a uma estação
 
 /**
  * @class Point
- * @brief Representa um ponto em um plano 2D com coordenadas (x, y), um identificador e um status de ativação.
+ * @brief Representa um ponto em um plano 2D com coordenadas (x, y), o índice de sua estação e um status de ativação.
  *
  * Esta classe fornece funcionalidades básicas para manipulação de pontos em um espaço bidimensional, 
  * incluindo cálculo de distância, ativação/desativação do ponto e comparação de igualdade.
@@ -15,7 +20,7 @@ class Point
 {
 private:
     double _x, _y;  ///< Coordenadas X e Y do ponto.
-    std::string _id;        ///< Identificador único do ponto.
+    stationidx_t _id;  ///< Índice da estação à qual o ponto pertence.
     bool _active;   ///< Status de ativação do ponto.
 
 public:
@@ -23,10 +28,10 @@ public:
      * @brief Construtor padrão que inicializa o ponto com coordenadas (x, y), id e status de ativação.
      * @param x Coordenada X do ponto.
      * @param y Coordenada Y do ponto.
-     * @param id Identificador do ponto.
+     * @param id Índice da estação do ponto.
      * @param active Status de ativação do ponto.
      */
-    Point(double x = 0, double y = 0, std::string id = "", bool active = true) : _x(x), _y(y), _id(id), _active(active) {}
+    Point(double x = 0, double y = 0, stationidx_t id = INVALIDSTATION, bool active = true) : _x(x), _y(y), _id(id), _active(active) {}
 
     /**
      * @brief Ativa o ponto, definindo o status de ativação como verdadeiro.
@@ -76,10 +81,10 @@ public:
     }
 
     /**
-     * @brief Retorna o identificador do ponto.
-     * @return O identificador do ponto.
+     * @brief Retorna o índice da estação do ponto.
+     * @return O índice da estação, ou INVALIDSTATION.
      */
-    std::string getId() const
+    stationidx_t getId() const
     {
         return _id;
     }
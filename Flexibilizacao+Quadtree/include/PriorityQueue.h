@@ -14,7 +14,7 @@ class PriorityQueue
 private:
     T *_heap;      ///< Ponteiro para o array que representa o heap
     int _size;     ///< Tamanho atual da fila de prioridade
-    int _capacity; ///< Capacidade máxima da fila de prioridade (padrão é 10000)
+    int _capacity; ///< Capacidade atual do heap, que dobra quando a fila enche
     bool _mode;    ///< Modo de operação da fila de prioridade (true = min heap, false = max heap)
 
     /**
@@ -57,10 +57,15 @@ private:
      */
     int rightChild(int index);
 
+    /**
+     * @brief Dobra a capacidade do heap, copiando os elementos para um novo array.
+     */
+    void grow();
+
 public:
     /**
      * @brief Construtor da classe PriorityQueue com capacidade e modo personalizados.
-     * @param capacity Capacidade máxima da fila de prioridade.
+     * @param capacity Capacidade inicial da fila de prioridade.
      * @param mode Modo de operação da fila de prioridade.
      */
     PriorityQueue(int capacity = 1000, bool mode = false);
@@ -71,9 +76,9 @@ public:
     ~PriorityQueue();
 
     /**
-     * @brief Se possível adiciona um elemento à fila de prioridade.
+     * @brief Adiciona um elemento à fila de prioridade.
      * @param data Elemento a ser adicionado.
-     * @details Este método tenta adicionar um elemento à fila de prioridade. Se o heap tiver capacidade, o elemento será adicionado normalmente. Caso contrário, o lança um excessão.
+     * @details Se o heap estiver cheio, sua capacidade é dobrada antes da inserção, de modo que o custo amortizado continua constante.
      */
     void push(T data);
 
@@ -86,9 +91,9 @@ public:
 
     /**
      * @brief Obtém o elemento de maior prioridade da fila.
-     * @return Elemento de maior prioridade.
+     * @return Referência constante para o elemento de maior prioridade, válida até a próxima modificação da fila.
      */
-    T top();
+    const T &top();
 
     /**
      * @brief Remove o elemento de maior prioridade da fila.
@@ -108,6 +113,11 @@ public:
      */
     int size();
 
+    /**
+     * @brief Remove todos os elementos, mantendo a capacidade já alocada para que a fila possa ser reaproveitada.
+     */
+    void clear();
+
     /**
      * @brief Troca o modo de operação e atualiza a fila de prioridade.
      */
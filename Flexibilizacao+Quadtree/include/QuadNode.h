@@ -3,56 +3,84 @@
 
 #include <iostream>
 #include <cmath>
+#include <cstdint>
+#include <vector>
 #include "Point.h"
 #include "Rectangle.h"
 #include "PriorityQueue.h"
 #include "Pair.h"
 
-#define INVALIDKEY -1   // Definição para chave inválida
-#define INVALIDADDR -2  // Definição para endereço inválido
+#define INVALIDADDR -2    // Definição para endereço inválido
+#define INVALIDBUCKET -1  // Definição para nó sem balde
+#define MAXBUCKETSIZE 256 // Maior número de pontos em um balde
 
-// Definição de tipos para chave e endereço do nó na QuadTree
-using quadnodekey_t = long;
-using quadnodeaddr_t = long;
+// Definição do tipo de endereço do nó na QuadTree
+using quadnodeaddr_t = int32_t;
+
+// Quadrantes de um nó, na ordem em que são testados por QuadNodeManager::localize
+enum Quadrant
+{
+    NE,
+    NW,
+    SW,
+    SE
+};
 
 /**
  * @class QuadNode
  * @brief Representa um nó de uma QuadTree, que pode conter um ponto e subdivisões para as regiões Nordeste, Noroeste, Sudeste e Sudoeste.
+ *
+ * O nó guarda apenas os dados lidos durante o percurso: coordenadas do ponto, limites em float arredondados
+ * para fora, endereços de 32 bits dos filhos e o contador de pontos ativos. O índice da estação do ponto no
+ * StationArena fica no vetor stations do QuadNodeManager, no mesmo índice do nó, de modo que cada nó ocupa uma
+ * linha de cache.
+ *
+ * Um nó sem ponto é uma folha: ela guarda até B pontos em um balde do QuadNodeManager e só é dividida quando
+ * o balde transborda, passando então a ter um ponto e filhos.
+ *
+ * Nós excluídos formam a lista de nós livres do QuadNodeManager, encadeada pelo campo ne.
  */
-class QuadNode {
+class alignas(64) QuadNode {
 private:
-    Rectangle _boundary;   ///< Limites do quadrante que o nó representa
-    quadnodekey_t key;     ///< Chave única do nó
+    double _x;             ///< Coordenada X do ponto armazenado neste nó
+    double _y;             ///< Coordenada Y do ponto armazenado neste nó
+    float _lbx, _lby;      ///< Canto inferior esquerdo dos limites, arredondado para baixo
+    float _rtx, _rty;      ///< Canto superior direito dos limites, arredondado para cima
     quadnodeaddr_t ne;     ///< Endereço do nó filho no quadrante Nordeste
     quadnodeaddr_t nw;     ///< Endereço do nó filho no quadrante Noroeste
     quadnodeaddr_t se;     ///< Endereço do nó filho no quadrante Sudeste
     quadnodeaddr_t sw;     ///< Endereço do nó filho no quadrante Sudoeste
-    Point *_point;         ///< Ponto armazenado neste nó, se houver
+    int32_t _activeCount;  ///< Número de pontos ativos na subárvore enraizada neste nó
+    int32_t _pointCount;   ///< Número de pontos, ativos ou não, na subárvore enraizada neste nó
+    int32_t _bucket;       ///< Balde com os pontos da folha, ou INVALIDBUCKET
+    int16_t _bucketCount;  ///< Número de pontos no balde
+    bool _hasPoint;        ///< Indica se o nó armazena um ponto
+    bool _active;          ///< Indica se o ponto armazenado neste nó está ativo
 
     /**
-     * @brief Construtor do QuadNode.
+     * @brief Construtor do QuadNode, sem ponto e sem filhos.
      * @param boundary Limites do quadrante.
-     * @param key Chave única do nó.
-     * @param ne Endereço do nó filho no quadrante Nordeste.
-     * @param nw Endereço do nó filho no quadrante Noroeste.
-     * @param se Endereço do nó filho no quadrante Sudeste.
-     * @param sw Endereço do nó filho no quadrante Sudoeste.
-     * @param ponto Ponto armazenado neste nó.
      */
-    QuadNode(Rectangle boundary = Rectangle(), quadnodekey_t key = INVALIDKEY, 
-             quadnodeaddr_t ne = INVALIDADDR, quadnodeaddr_t nw = INVALIDADDR, 
-             quadnodeaddr_t se = INVALIDADDR, quadnodeaddr_t sw = INVALIDADDR, 
-             Point *ponto = nullptr);
+    QuadNode(const Rectangle &boundary = Rectangle());
 
     /**
      * @brief Reseta o conteúdo do nó, definindo valores padrão.
      */
     void reset();
 
+    /**
+     * @brief Calcula o quadrado da distância euclidiana entre o ponto armazenado no nó e outro ponto.
+     * @param p O ponto de referência.
+     * @return O quadrado da distância entre os dois pontos.
+     */
+    double distanceSquared(const Point &p) const;
+
     friend class QuadNodeManager;  ///< Permite que QuadNodeManager acesse membros privados
     friend class QuadTree;         ///< Permite que QuadTree acesse membros privados
 };
 
+static_assert(sizeof(QuadNode) == 64, "QuadNode deve ocupar uma linha de cache");
+
 /**
  * @class QuadNodeManager
  * @brief Gerencia os nós da QuadTree, permitindo a criação, manipulação e destruição de nós.
@@ -60,35 +88,85 @@ private:
 class QuadNodeManager {
 private:
     QuadNode *nodes;       ///< Vetor dinâmico de nós
-    size_t _size = 0;      ///< Número atual de nós
+    stationidx_t *stations; ///< Vetor com a estação do ponto de cada nó, indexado pelo endereço do nó
+    size_t _size = 0;      ///< Número de posições do vetor de nós já usadas, incluindo os nós livres
     size_t _capacity = 0;  ///< Capacidade máxima de nós
+    quadnodeaddr_t firstAvail = INVALIDADDR; ///< Primeiro nó da lista de nós livres
+    size_t _numFree = 0;   ///< Número de nós na lista de nós livres
+
+    // Baldes das folhas: o balde b ocupa as posições [b * B, (b + 1) * B) de cada vetor, com as coordenadas
+    // em vetores separados para que a varredura de uma folha use o cálculo vetorizado de distâncias
+    int _bucketSize = 0;                      ///< Número máximo de pontos em um balde (B); 0 desativa os baldes
+    std::vector<double> bucketX;              ///< Coordenadas X dos pontos dos baldes
+    std::vector<double> bucketY;              ///< Coordenadas Y dos pontos dos baldes
+    std::vector<stationidx_t> bucketStations; ///< Estação de cada ponto dos baldes
+    std::vector<uint8_t> bucketActive;        ///< Indica se cada ponto dos baldes está ativo
+    std::vector<int32_t> freeBuckets;         ///< Baldes liberados, reaproveitados antes de criar novos
+
+    /**
+     * @brief Determina o quadrante de um nó que contém um ponto, sem construir os retângulos dos quadrantes.
+     * O ponto deve estar contido nos limites do nó.
+     * @param addr Endereço do nó cujo ponto define a divisão.
+     * @param p Ponto a ser classificado.
+     * @return O quadrante (NE, NW, SW ou SE).
+     */
+    int quadrant(quadnodeaddr_t addr, const Point &p) const;
+
+    /**
+     * @brief Constrói os limites de um quadrante de um nó.
+     * @param addr Endereço do nó cujo ponto define a divisão.
+     * @param q O quadrante desejado.
+     * @return O retângulo correspondente ao quadrante.
+     */
+    Rectangle quadrantBoundary(quadnodeaddr_t addr, int q) const;
+
+    /**
+     * @brief Obtém um balde livre, criando-o se necessário.
+     * @return O índice do balde.
+     */
+    int32_t createBucket();
 
 public:
     /**
      * @brief Inicializa o gerenciador de nós com uma capacidade específica.
      * @param capacity Capacidade inicial para o vetor de nós.
+     * @param bucketSize Número máximo de pontos no balde de cada folha; 0 guarda um ponto por nó.
      */
-    void initialize(long capacity);
+    void initialize(long capacity, int bucketSize = 0);
 
     /**
-     * @brief Cria um novo nó e o adiciona ao gerenciador.
+     * @brief Cria um novo nó e o adiciona ao gerenciador, reaproveitando um nó livre se houver.
      * @param pn Nó a ser adicionado.
      * @return Endereço do nó criado.
      */
     quadnodeaddr_t createNode(const QuadNode &pn);
 
     /**
-     * @brief Exclui um nó específico com base no endereço.
-     * @param addr Endereço do nó a ser excluído.
+     * @brief Exclui um nó específico com base no endereço, liberando seu balde e colocando-o na lista de nós livres.
+     * @param addr Endereço do nó a ser excluído, que não pode ser filho de outro nó.
      */
     void deleteNode(quadnodeaddr_t addr);
 
     /**
-     * @brief Recupera um nó específico com base no endereço.
+     * @brief Recupera um nó específico com base no endereço, sem copiá-lo.
      * @param addr Endereço do nó a ser recuperado.
      * @return O nó recuperado.
      */
-    QuadNode getNode(quadnodeaddr_t addr) const;
+    const QuadNode &getNode(quadnodeaddr_t addr) const;
+
+    /**
+     * @brief Retorna o ponto armazenado em um nó.
+     * @param addr Endereço do nó.
+     * @return Cópia do ponto, montada a partir do nó e do índice de sua estação.
+     */
+    Point getPoint(quadnodeaddr_t addr) const;
+
+    /**
+     * @brief Armazena um ponto em um nó, copiando suas coordenadas e seu estado para o nó.
+     * @param addr Endereço do nó.
+     * @param p Ponto a ser armazenado.
+     */
+    void setPoint(quadnodeaddr_t addr, const Point &p);
 
     /**
      * @brief Armazena um nó em um endereço específico.
@@ -98,10 +176,73 @@ public:
     void putNode(quadnodeaddr_t addr, QuadNode &pn);
 
     /**
-     * @brief Destroi todos os nós e libera a memória.
+     * @brief Destroi todos os nós e libera a memória. Chamadas seguintes não têm efeito.
      */
     void destroy();
 
+    /**
+     * @brief Verifica se um nó armazena um ponto, comparando a estação e as coordenadas.
+     * @param addr Endereço do nó.
+     * @param p Ponto procurado.
+     * @return true se o nó armazena p.
+     */
+    bool holds(quadnodeaddr_t addr, const Point &p) const;
+
+    /**
+     * @brief Acrescenta um ponto ao balde de uma folha, que não pode estar cheio.
+     * @param addr Endereço da folha.
+     * @param p Ponto a ser acrescentado.
+     */
+    void addToBucket(quadnodeaddr_t addr, const Point &p);
+
+    /**
+     * @brief Retira todos os pontos do balde de uma folha e libera o balde.
+     * @param addr Endereço da folha.
+     * @param out Vetor que recebe os pontos retirados.
+     */
+    void takeBucket(quadnodeaddr_t addr, std::vector<Point> &out);
+
+    /**
+     * @brief Remove um ponto do balde de uma folha, colocando o último ponto do balde em seu lugar.
+     * O balde é liberado quando fica vazio.
+     * @param addr Endereço da folha.
+     * @param slot Posição do ponto nos vetores dos baldes, como retornada por bucketSlot.
+     */
+    void removeFromBucket(quadnodeaddr_t addr, long slot);
+
+    /**
+     * @brief Procura um ponto no balde de uma folha, comparando a estação e as coordenadas.
+     * @param addr Endereço da folha.
+     * @param p Ponto procurado.
+     * @return A posição do ponto nos vetores dos baldes, ou -1 se ele não estiver no balde.
+     */
+    long bucketSlot(quadnodeaddr_t addr, const Point &p) const;
+
+    /**
+     * @brief Retorna um ponto dos baldes.
+     * @param slot Posição do ponto nos vetores dos baldes.
+     * @return Cópia do ponto.
+     */
+    Point getBucketPoint(long slot) const;
+
+    /**
+     * @brief Renumera os nós, movendo cada nó (e sua estação) para o novo endereço e atualizando os filhos.
+     * Os baldes são regravados na nova ordem dos nós, sem os baldes liberados.
+     * @param newAddr Novo endereço de cada nó, indexado pelo endereço atual; deve ser uma permutação de 0.._size-1.
+     */
+    void permute(const std::vector<quadnodeaddr_t> &newAddr);
+
+    /**
+     * @brief Descarta os nós a partir de um endereço e esvazia a lista de nós livres.
+     * @param size Novo número de nós; todos os nós a partir dele devem estar livres.
+     */
+    void truncate(size_t size);
+
+    /**
+     * @brief Retorna o número de nós em uso, sem contar os nós livres.
+     */
+    size_t size() const;
+
     /**
      * @brief Localiza o quadrante dentro do nó que contém um ponto específico.
      * @param addr Endereço do nó onde a busca será iniciada.
@@ -110,6 +251,14 @@ public:
      */
     quadnodeaddr_t localize(quadnodeaddr_t addr, const Point &p);
 
+    /**
+     * @brief Retorna o filho de um nó cujo quadrante contém um ponto, sem criar nós.
+     * @param addr Endereço do nó pai.
+     * @param p Ponto a ser localizado.
+     * @return O endereço do filho, ou INVALIDADDR se ele não existir.
+     */
+    quadnodeaddr_t child(quadnodeaddr_t addr, const Point &p) const;
+
     friend class QuadTree;  ///< Permite que QuadTree acesse membros privados
 };
 
@@ -2,6 +2,20 @@
 #define QUADTREE_H
 
 #include "QuadNode.h"
+#include "BoundedPriorityQueue.h"
+#include <vector>
+
+#define DEFAULTBUCKETSIZE 32 // Número padrão de pontos por folha
+
+/**
+ * @brief Ordens em que QuadTree::reorder pode dispor os nós no vetor de nós.
+ */
+enum NodeOrder
+{
+    MORTON_ORDER,  ///< Curva Z sobre as coordenadas dos pontos dos nós
+    HILBERT_ORDER, ///< Curva de Hilbert sobre as coordenadas dos pontos dos nós
+    VEB_ORDER      ///< van Emde Boas: a árvore é dividida pela metade da altura, recursivamente
+};
 
 /**
  * @class QuadTree
@@ -15,49 +29,173 @@ class QuadTree
 private:
     QuadNodeManager nodeManager; ///< Gerenciador de nós que armazena e gerencia os nós da árvore quaternária.
     quadnodeaddr_t root;         ///< Endereço do nó raiz da árvore.
+    Rectangle boundary;          ///< Limites exatos da área coberta pela árvore.
+
+    /**
+     * @brief Soma delta ao contador de pontos ativos de todos os nós no caminho da raiz até o nó de p.
+     * @param p O ponto armazenado na árvore.
+     * @param delta Variação do número de pontos ativos.
+     * @return true se o ponto foi encontrado na árvore, false caso contrário.
+     */
+    bool updateActiveCount(const Point &p, long delta);
+
+    /**
+     * @brief Constrói a subárvore de um nó vazio a partir de um intervalo de pontos contidos em seus limites.
+     * @param addr Endereço do nó vazio que será a raiz da subárvore.
+     * @param begin Início do intervalo de pontos.
+     * @param end Fim do intervalo de pontos.
+     */
+    void build(quadnodeaddr_t addr, std::vector<Point *>::iterator begin, std::vector<Point *>::iterator end);
+
+    /**
+     * @brief Retira todos os pontos da subárvore de um nó e exclui seus descendentes.
+     *
+     * O nó permanece na árvore, com os mesmos limites, como uma folha vazia.
+     *
+     * @param addr Endereço da raiz da subárvore.
+     * @param out Vetor que recebe os pontos retirados.
+     */
+    void detach(quadnodeaddr_t addr, std::vector<Point> &out);
+
+    /**
+     * @brief Acrescenta a order os nós das primeiras levels camadas da subárvore de addr, em ordem van Emde Boas.
+     * @param addr Raiz da subárvore.
+     * @param levels Número de camadas a dispor, contando a raiz.
+     * @param order Vetor que recebe os endereços na nova ordem.
+     */
+    void vebOrder(quadnodeaddr_t addr, int levels, std::vector<quadnodeaddr_t> &order) const;
+
+    /**
+     * @brief Acrescenta a out os nós que estão depth níveis abaixo de addr.
+     */
+    void descendantsAt(quadnodeaddr_t addr, int depth, std::vector<quadnodeaddr_t> &out) const;
+
+    /**
+     * @brief Calcula a altura da subárvore de addr, em número de camadas.
+     */
+    int height(quadnodeaddr_t addr) const;
+
+    /**
+     * @brief Oferece à fila de resultados os pontos ativos do balde de uma folha.
+     *
+     * As distâncias de todos os pontos do balde são calculadas de uma vez, com o cálculo vetorizado.
+     *
+     * @param leaf A folha.
+     * @param p O ponto de referência.
+     * @param K O número de vizinhos procurados.
+     * @param pq A fila com os K vizinhos mais próximos encontrados até agora.
+     */
+    void scanBucket(const QuadNode &leaf, const Point &p, int K, BoundedPriorityQueue<Pair<double, Point>> &pq) const;
 
 public:
     /**
      * @brief Construtor da classe QuadTree.
      * @param numNodes Número máximo de nós que a árvore pode conter.
      * @param boundary Limites iniciais que definem a área coberta pela árvore.
+     * @param bucketSize Número máximo de pontos guardados em cada folha, de 0 a MAXBUCKETSIZE. As folhas só são
+     * divididas quando seu balde transborda; com 0, cada nó guarda exatamente um ponto.
      */
-    QuadTree(long numNodes, Rectangle boundary);
+    QuadTree(long numNodes, Rectangle boundary, int bucketSize = DEFAULTBUCKETSIZE);
 
     /**
      * @brief Busca um ponto na árvore quaternária.
      * @param p O ponto a ser buscado.
-     * @return O endereço do nó que contém o ponto, ou INVALIDADDR se o ponto não for encontrado.
+     * @return O endereço do nó ou da folha que contém o ponto, ou INVALIDADDR se o ponto não for encontrado.
      */
     quadnodeaddr_t search(Point &p);
 
     /**
      * @brief Insere um ponto na árvore quaternária.
+     *
+     * O ponto entra no balde da folha que o contém. Se o balde estiver cheio, a folha é reconstruída com seus
+     * pontos e o novo, como em build: o ponto mediano passa a dividi-la e os demais vão para folhas filhas.
+     *
      * @param p O ponto a ser inserido.
-     * @return O endereço do nó onde o ponto foi inserido.
+     * @return O endereço do nó ou da folha onde o ponto foi inserido.
      */
     quadnodeaddr_t insert(Point &p);
 
     /**
-     * @brief Destroi a árvore quaternária, liberando os recursos alocados.
+     * @brief Remove um ponto da árvore quaternária.
+     *
+     * Se o ponto estiver no balde de uma folha, ele apenas sai do balde. Se ele dividir um nó, a subárvore desse
+     * nó é reconstruída sem ele, como em build. Em seguida, o nó mais alto do caminho cuja subárvore passou a
+     * caber em um balde é reduzido a uma folha, e folhas vazias são excluídas. Os nós e baldes liberados são
+     * reaproveitados pelas próximas inserções.
+     *
+     * @param p O ponto a ser removido, identificado pela estação e pelas coordenadas.
+     * @return true se o ponto foi encontrado e removido, false caso contrário.
      */
-    void destroy();
+    bool remove(Point &p);
 
     /**
-     * @brief Realiza uma busca pelos K pontos mais próximos de um ponto dado.
-     * @param p O ponto de referência para a busca.
-     * @param K O número de vizinhos mais próximos a serem encontrados.
-     * @param pq Uma fila de prioridade que armazenará os pares (distância, ponto) dos K vizinhos mais próximos.
+     * @brief Retorna o número de nós em uso pela árvore.
      */
-    void KNNSearch(const Point &p, int K, PriorityQueue<Pair<double, Point>> &pq) const;
+    long nodeCount() const;
+
+    /**
+     * @brief Retorna os limites da área coberta pela árvore; pontos fora deles não são armazenados.
+     */
+    const Rectangle &getBoundary() const;
+
+    /**
+     * @brief Constrói a árvore de uma só vez a partir de um conjunto de pontos.
+     *
+     * Cada nó recebe o ponto mediano (na ordem de x e depois y) dos pontos de sua subárvore, de modo que nenhum
+     * quadrante fica com mais da metade deles e a altura é logarítmica, independente da ordem de entrada.
+     * Subárvores com até B pontos viram uma única folha.
+     * Os nós são criados em pré-ordem, então cada subárvore ocupa um trecho contíguo do vetor de nós.
+     * Se a árvore já tiver pontos, eles são inseridos um a um. Pontos fora dos limites são ignorados.
+     *
+     * @param points Os pontos a serem inseridos; o vetor é reordenado.
+     */
+    void build(std::vector<Point *> &points);
+
+    /**
+     * @brief Renumera os nós da árvore para que nós acessados juntos fiquem próximos no vetor de nós.
+     *
+     * Nas curvas de Morton e Hilbert, nós com pontos próximos no espaço ficam próximos no vetor, o que
+     * favorece as buscas de vizinhos. Na ordem van Emde Boas, cada pequena subárvore ocupa um trecho contíguo,
+     * o que favorece os percursos da raiz até as folhas para qualquer tamanho de página ou de linha de cache.
+     * Os nós livres deixados por remove são descartados, e a árvore volta a ocupar um trecho contíguo.
+     *
+     * @param order A ordem desejada.
+     */
+    void reorder(NodeOrder order);
+
+    /**
+     * @brief Ativa um ponto da árvore, atualizando os contadores de pontos ativos das subárvores.
+     * @param p O ponto a ser ativado.
+     */
+    void activate(Point &p);
+
+    /**
+     * @brief Desativa um ponto da árvore, atualizando os contadores de pontos ativos das subárvores.
+     *
+     * As buscas de vizinhos descartam subárvores cujo contador é zero.
+     *
+     * @param p O ponto a ser desativado.
+     */
+    void deactivate(Point &p);
+
+    /**
+     * @brief Destroi a árvore quaternária, liberando os recursos alocados.
+     */
+    void destroy();
 
     /**
      * @brief Realiza uma busca pelos K pontos mais próximos de um ponto dado considerando uma heuristica.
+     *
+     * A busca é exata e do tipo best-first: os nós são visitados em ordem crescente da heurística, a menor
+     * distância entre p e o quadrante de cada filho, calculado a partir do ponto do pai, de modo que os filhos só
+     * são acessados quando retirados da fila. A busca termina quando o menor limite pendente não supera o
+     * K-ésimo vizinho encontrado, portanto o resultado é exato.
+     *
      * @param p O ponto de referência para a busca.
      * @param K O número de vizinhos mais próximos a serem encontrados.
-     * @param pq Uma fila de prioridade que armazenará os pares (distância, ponto) dos K vizinhos mais próximos.
+     * @param pq Uma fila de capacidade K que armazenará os pares (quadrado da distância, ponto) dos K vizinhos mais próximos.
      */
-    void HeuristicKNNSearch(const Point &p, int K, PriorityQueue<Pair<double, Point>> &pq) const;
+    void HeuristicKNNSearch(const Point &p, int K, BoundedPriorityQueue<Pair<double, Point>> &pq) const;
 };
 
 #endif // QUADTREE_H
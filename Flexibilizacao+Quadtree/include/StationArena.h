@@ -0,0 +1,167 @@
+#ifndef STATIONARENA_H
+#define STATIONARENA_H
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include "Point.h"
+#include "Address.h"
+#include "BoundedPriorityQueue.h"
+#include "DistanceKernel.h"
+
+/**
+ * @class StationArena
+ * @brief Armazena de forma contígua todas as estações da base: o texto do arquivo, os pontos e os endereços.
+ *
+ * A estação de índice i é formada por point(i) e address(i). A árvore e a tabela hash guardam apenas esse
+ * índice de 32 bits, e os campos de texto dos endereços apontam para o próprio conteúdo do arquivo. Assim
+ * toda a base ocupa três blocos de memória, liberados de uma vez com o StationArena.
+ */
+class StationArena
+{
+private:
+    std::vector<char> _text;             ///< Conteúdo da base, com os campos terminados por '\0'
+    std::vector<Point> _points;          ///< Ponto de cada estação
+    std::vector<AddressInfo> _addresses; ///< Endereço de cada estação
+    std::vector<double> _xs;             ///< Coordenada X de cada estação, contígua para o cálculo vetorizado de distâncias
+    std::vector<double> _ys;             ///< Coordenada Y de cada estação
+    std::vector<uint8_t> _searchable;    ///< Se a estação pode ser devolvida pela busca exaustiva
+
+public:
+    /**
+     * @brief Construtor que reserva espaço para um número de estações.
+     * @param capacity Número esperado de estações.
+     */
+    explicit StationArena(size_t capacity)
+    {
+        _points.reserve(capacity);
+        _addresses.reserve(capacity);
+        _xs.reserve(capacity);
+        _ys.reserve(capacity);
+        _searchable.reserve(capacity);
+    }
+
+    /**
+     * @brief Retorna o buffer que guarda o texto da base.
+     *
+     * O buffer deve ser preenchido antes de adicionar as estações e não pode ser redimensionado depois,
+     * pois os endereços apontam para ele.
+     *
+     * @return Referência para o buffer.
+     */
+    std::vector<char> &text()
+    {
+        return _text;
+    }
+
+    /**
+     * @brief Adiciona uma estação ativa.
+     * @param x Coordenada X da estação.
+     * @param y Coordenada Y da estação.
+     * @param address Endereço da estação, com os textos apontando para text().
+     * @return O índice da nova estação.
+     */
+    stationidx_t add(double x, double y, const AddressInfo &address)
+    {
+        stationidx_t idx = static_cast<stationidx_t>(_points.size());
+        _points.push_back(Point(x, y, idx));
+        _addresses.push_back(address);
+        _xs.push_back(x);
+        _ys.push_back(y);
+        _searchable.push_back(1);
+        return idx;
+    }
+
+    /**
+     * @brief Retira uma estação do conjunto percorrido pela busca exaustiva.
+     *
+     * Usado para as estações que a árvore não armazena (fora dos seus limites), de modo que KNNSearch
+     * devolva as mesmas estações que a busca na árvore.
+     *
+     * @param idx Índice da estação.
+     */
+    void exclude(stationidx_t idx)
+    {
+        _searchable[idx] = 0;
+    }
+
+    /**
+     * @brief Retorna o ponto de uma estação.
+     * @param idx Índice da estação.
+     * @return Referência para o ponto.
+     */
+    Point &point(stationidx_t idx)
+    {
+        return _points[idx];
+    }
+
+    /**
+     * @brief Retorna o endereço de uma estação.
+     * @param idx Índice da estação.
+     * @return Referência para o endereço.
+     */
+    AddressInfo &address(stationidx_t idx)
+    {
+        return _addresses[idx];
+    }
+
+    /**
+     * @brief Retorna o número de estações armazenadas.
+     * @return O número de estações.
+     */
+    size_t size() const
+    {
+        return _points.size();
+    }
+
+    /**
+     * @brief Busca exaustiva pelas K estações ativas mais próximas de um ponto.
+     *
+     * As distâncias ao quadrado são calculadas em blocos por squaredDistances, sobre as coordenadas guardadas
+     * de forma contígua, e só as estações mais próximas que a K-ésima atual têm o estado consultado. Estações
+     * retiradas com exclude nunca são devolvidas.
+     *
+     * @param p O ponto de referência.
+     * @param K O número de estações a serem encontradas.
+     * @param pq Uma fila de capacidade K que armazenará os pares (quadrado da distância, ponto) das K estações mais próximas.
+     */
+    void KNNSearch(const Point &p, int K, BoundedPriorityQueue<Pair<double, Point>> &pq) const
+    {
+        const int tamanhoBloco = 256;
+        double distancias[tamanhoBloco];
+        int total = static_cast<int>(_points.size());
+        double limite = std::numeric_limits<double>::infinity(); // Distância da K-ésima estação, quando já houver K
+
+        if (K <= 0)
+        {
+            return;
+        }
+
+        for (int inicio = 0; inicio < total; inicio += tamanhoBloco)
+        {
+            int n = std::min(tamanhoBloco, total - inicio);
+            squaredDistances(_xs.data() + inicio, _ys.data() + inicio, n, p.getX(), p.getY(), distancias);
+
+            for (int i = 0; i < n; i++)
+            {
+                if (distancias[i] < limite && _addresses[inicio + i]._ativo && _searchable[inicio + i])
+                {
+                    if (pq.size() < K)
+                    {
+                        pq.push(Pair<double, Point>(distancias[i], _points[inicio + i]));
+                    }
+                    else
+                    {
+                        pq.replaceTop(Pair<double, Point>(distancias[i], _points[inicio + i]));
+                    }
+                    if (pq.size() == K)
+                    {
+                        limite = pq.top().getFirst();
+                    }
+                }
+            }
+        }
+    }
+};
+
+#endif // STATIONARENA_H
@@ -0,0 +1,225 @@
+/**
+ * @file remocao.cpp
+ * @brief Teste de regressão de QuadTree::remove, comparado a uma varredura exaustiva.
+ *
+ * Para cada número de pontos por folha, constrói uma árvore com capacidade para os pontos e a raiz, e faz
+ * rodadas de remoção, reinserção, ativação e desativação de pontos sorteados, com uma renumeração dos nós a
+ * cada poucas rodadas. Parte dos pontos repete as coordenadas de outro, para que a remoção precise distinguir
+ * as estações. Depois de cada rodada confere que:
+ * - remove encontra os pontos presentes e recusa os já removidos;
+ * - search encontra os pontos presentes;
+ * - HeuristicKNNSearch devolve as mesmas distâncias que a varredura dos pontos presentes e ativos, e só
+ *   pontos presentes e ativos;
+ * - o número de nós em uso não passa do número de pontos presentes mais a raiz, já que cada nó guarda o seu
+ *   ponto ou um balde não vazio, e folhas vazias são excluídas.
+ * Como a capacidade da árvore não sobra, as rodadas só completam se os nós liberados voltarem a ser usados. Na
+ * metade das rodadas e ao fim, os pontos são removidos até restarem B, e a árvore deve ter sido reduzida à raiz.
+ *
+ * Uso: ./remocao.out. Termina com código 1 e descreve a primeira divergência, se houver.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "QuadTree.h"
+
+#define NUMPONTOS 3000
+#define NUMRODADAS 20
+#define NUMCONSULTAS 100
+
+/**
+ * @brief Interrompe o teste, informando a divergência encontrada.
+ */
+static void falha(int bucketSize, int rodada, const char *mensagem)
+{
+    std::cerr << "B = " << bucketSize << ", rodada " << rodada << ": " << mensagem << std::endl;
+    std::exit(1);
+}
+
+/**
+ * @brief Compara uma consulta da árvore com a varredura dos pontos presentes e ativos.
+ */
+static bool confereConsulta(const QuadTree &quadTree, const std::vector<Point> &pontos, const std::vector<bool> &presente,
+                            const Point &p, int K)
+{
+    std::vector<double> esperado;
+    for (size_t i = 0; i < pontos.size(); i++)
+    {
+        if (presente[i] && pontos[i].isActive())
+        {
+            double dx = pontos[i].getX() - p.getX();
+            double dy = pontos[i].getY() - p.getY();
+            esperado.push_back(dx * dx + dy * dy);
+        }
+    }
+    std::sort(esperado.begin(), esperado.end());
+    esperado.resize(std::min(esperado.size(), static_cast<size_t>(K)));
+
+    BoundedPriorityQueue<Pair<double, Point>> pq(K);
+    quadTree.HeuristicKNNSearch(p, K, pq);
+    pq.sort();
+    if (static_cast<size_t>(pq.size()) != esperado.size())
+    {
+        return false;
+    }
+
+    size_t i = 0;
+    for (const Pair<double, Point> &resultado : pq)
+    {
+        // O ponto devolvido deve ser o da estação, e não uma cópia antiga deixada em um balde liberado
+        const Point &q = resultado.getSecond();
+        if (q.getId() >= pontos.size() || !presente[q.getId()] || !pontos[q.getId()].isActive() ||
+            q.getX() != pontos[q.getId()].getX() || q.getY() != pontos[q.getId()].getY())
+        {
+            return false;
+        }
+        if (std::fabs(resultado.getFirst() - esperado[i]) > 1e-6 * (1 + esperado[i]))
+        {
+            return false;
+        }
+        i++;
+    }
+    return true;
+}
+
+/**
+ * @brief Remove pontos presentes até restarem bucketSize e confere que a árvore foi reduzida à raiz.
+ */
+static void esvazia(QuadTree &quadTree, std::vector<Point> &pontos, std::vector<bool> &presente, int bucketSize, int rodada)
+{
+    int restantes = static_cast<int>(std::count(presente.begin(), presente.end(), true));
+    for (stationidx_t i = 0; i < NUMPONTOS && restantes > bucketSize; i++)
+    {
+        if (presente[i])
+        {
+            if (!quadTree.remove(pontos[i]))
+            {
+                falha(bucketSize, rodada, "remove não encontrou um ponto presente");
+            }
+            presente[i] = false;
+            restantes--;
+        }
+    }
+    if (quadTree.nodeCount() != 1)
+    {
+        falha(bucketSize, rodada, "a árvore com até B pontos não foi reduzida à raiz");
+    }
+}
+
+/**
+ * @brief Executa as rodadas com um número de pontos por folha.
+ */
+static void testa(int bucketSize)
+{
+    std::mt19937 gen(17 + bucketSize);
+    std::uniform_real_distribution<double> xs(600000, 601000);
+    std::uniform_real_distribution<double> ys(7800000, 7801000);
+
+    std::vector<Point> pontos;
+    for (stationidx_t i = 0; i < NUMPONTOS; i++)
+    {
+        if (i >= 10 && gen() % 10 == 0)
+        {
+            const Point &original = pontos[gen() % i];
+            pontos.push_back(Point(original.getX(), original.getY(), i));
+        }
+        else
+        {
+            pontos.push_back(Point(xs(gen), ys(gen), i));
+        }
+    }
+    std::vector<bool> presente(NUMPONTOS, true);
+
+    QuadTree quadTree(NUMPONTOS + 1, Rectangle(Point(150000, 7500000), Point(7500000, 10000000)), bucketSize);
+    std::vector<Point *> ponteiros;
+    for (Point &p : pontos)
+    {
+        ponteiros.push_back(&p);
+    }
+    quadTree.build(ponteiros);
+
+    NodeOrder ordens[3] = {MORTON_ORDER, HILBERT_ORDER, VEB_ORDER};
+    for (int rodada = 0; rodada < NUMRODADAS; rodada++)
+    {
+        for (stationidx_t i = 0; i < NUMPONTOS; i++)
+        {
+            unsigned sorteio = gen() % 6;
+            if (presente[i] && sorteio < 2)
+            {
+                if (!quadTree.remove(pontos[i]))
+                {
+                    falha(bucketSize, rodada, "remove não encontrou um ponto presente");
+                }
+                presente[i] = false;
+                if (quadTree.remove(pontos[i]))
+                {
+                    falha(bucketSize, rodada, "remove encontrou um ponto já removido");
+                }
+            }
+            else if (!presente[i] && sorteio < 3)
+            {
+                if (quadTree.insert(pontos[i]) == INVALIDADDR)
+                {
+                    falha(bucketSize, rodada, "insert recusou um ponto dentro dos limites");
+                }
+                presente[i] = true;
+            }
+            else if (presente[i] && sorteio == 3)
+            {
+                if (pontos[i].isActive())
+                {
+                    quadTree.deactivate(pontos[i]);
+                }
+                else
+                {
+                    quadTree.activate(pontos[i]);
+                }
+            }
+        }
+        if (rodada % 5 == 4)
+        {
+            quadTree.reorder(ordens[(rodada / 5) % 3]);
+        }
+        if (rodada == NUMRODADAS / 2)
+        {
+            esvazia(quadTree, pontos, presente, bucketSize, rodada);
+        }
+
+        if (quadTree.nodeCount() > std::count(presente.begin(), presente.end(), true) + 1)
+        {
+            falha(bucketSize, rodada, "há mais nós em uso que pontos presentes");
+        }
+
+        for (stationidx_t i = 0; i < NUMPONTOS; i++)
+        {
+            if (presente[i] && quadTree.search(pontos[i]) == INVALIDADDR)
+            {
+                falha(bucketSize, rodada, "search não encontrou um ponto presente");
+            }
+        }
+        for (int c = 0; c < NUMCONSULTAS; c++)
+        {
+            int K = c % 3 == 0 ? 1 : (c % 3 == 1 ? 10 : 200);
+            if (!confereConsulta(quadTree, pontos, presente, Point(xs(gen), ys(gen)), K))
+            {
+                falha(bucketSize, rodada, "HeuristicKNNSearch diverge da varredura exaustiva");
+            }
+        }
+    }
+
+    esvazia(quadTree, pontos, presente, bucketSize, NUMRODADAS);
+    quadTree.destroy();
+}
+
+int main()
+{
+    int tamanhos[3] = {0, 4, DEFAULTBUCKETSIZE};
+    for (int bucketSize : tamanhos)
+    {
+        testa(bucketSize);
+    }
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include "BoundedPriorityQueue.h"
+#include <stdexcept>
+
+template <typename T, typename Compare>
+BoundedPriorityQueue<T, Compare>::BoundedPriorityQueue(int capacity) : _size(0), _capacity(capacity)
+{
+    _heap = new T[_capacity > 0 ? _capacity : 1];
+}
+
+template <typename T, typename Compare>
+BoundedPriorityQueue<T, Compare>::~BoundedPriorityQueue()
+{
+    delete[] _heap;
+}
+
+template <typename T, typename Compare>
+void BoundedPriorityQueue<T, Compare>::siftUp(int index, const T &data)
+{
+    // Os pais melhores que o elemento descem um nível, abrindo caminho até a posição final
+    while (index > 0)
+    {
+        int parent = (index - 1) / 2;
+        if (!_less(_heap[parent], data))
+        {
+            break;
+        }
+        _heap[index] = _heap[parent];
+        index = parent;
+    }
+    _heap[index] = data;
+}
+
+template <typename T, typename Compare>
+void BoundedPriorityQueue<T, Compare>::siftDown(int index, const T &data)
+{
+    // O pior dos filhos sobe um nível enquanto for pior que o elemento
+    int child = 2 * index + 1;
+    while (child < _size)
+    {
+        child += (child + 1 < _size) && _less(_heap[child], _heap[child + 1]);
+        if (!_less(data, _heap[child]))
+        {
+            break;
+        }
+        _heap[index] = _heap[child];
+        index = child;
+        child = 2 * index + 1;
+    }
+    _heap[index] = data;
+}
+
+template <typename T, typename Compare>
+void BoundedPriorityQueue<T, Compare>::push(const T &data)
+{
+    if (_size == _capacity)
+    {
+        throw std::out_of_range("Bounded Priority Queue is full.");
+    }
+    siftUp(_size++, data);
+}
+
+template <typename T, typename Compare>
+void BoundedPriorityQueue<T, Compare>::replaceTop(const T &data)
+{
+    if (_size <= 0)
+    {
+        throw std::out_of_range("Bounded Priority Queue is empty.");
+    }
+    siftDown(0, data);
+}
+
+template <typename T, typename Compare>
+bool BoundedPriorityQueue<T, Compare>::offer(const T &data)
+{
+    if (_size < _capacity)
+    {
+        siftUp(_size++, data);
+        return true;
+    }
+    if (_size > 0 && _less(data, _heap[0]))
+    {
+        siftDown(0, data);
+        return true;
+    }
+    return false;
+}
+
+template <typename T, typename Compare>
+const T &BoundedPriorityQueue<T, Compare>::top() const
+{
+    if (_size <= 0)
+    {
+        throw std::out_of_range("Bounded Priority Queue is empty.");
+    }
+    return _heap[0];
+}
+
+template <typename T, typename Compare>
+void BoundedPriorityQueue<T, Compare>::pop()
+{
+    if (_size <= 0)
+    {
+        throw std::out_of_range("Bounded Priority Queue is empty.");
+    }
+    _size--;
+    if (_size > 0)
+    {
+        siftDown(0, _heap[_size]);
+    }
+}
+
+template <typename T, typename Compare>
+void BoundedPriorityQueue<T, Compare>::sort()
+{
+    // A cada passo o pior elemento restante vai para a posição que sai do heap, logo depois dos melhores
+    int size = _size;
+    while (_size > 1)
+    {
+        T worst = _heap[0];
+        _size--;
+        siftDown(0, _heap[_size]);
+        _heap[_size] = worst;
+    }
+    _size = size;
+}
+
+template <typename T, typename Compare>
+void BoundedPriorityQueue<T, Compare>::clear()
+{
+    _size = 0;
+}
+
+template <typename T, typename Compare>
+const T *BoundedPriorityQueue<T, Compare>::begin() const
+{
+    return _heap;
+}
+
+template <typename T, typename Compare>
+const T *BoundedPriorityQueue<T, Compare>::end() const
+{
+    return _heap + _size;
+}
+
+template <typename T, typename Compare>
+bool BoundedPriorityQueue<T, Compare>::empty() const
+{
+    return _size == 0;
+}
+
+template <typename T, typename Compare>
+bool BoundedPriorityQueue<T, Compare>::full() const
+{
+    return _size == _capacity;
+}
+
+template <typename T, typename Compare>
+int BoundedPriorityQueue<T, Compare>::size() const
+{
+    return _size;
+}
+
+template <typename T, typename Compare>
+int BoundedPriorityQueue<T, Compare>::capacity() const
+{
+    return _capacity;
+}
+
+// Especifica a implementação do template para os tipos utilizados nos algoritmos.
+template class BoundedPriorityQueue<Pair<double, Point>>;
+template class BoundedPriorityQueue<Pair<double, int>>;
@@ -1,18 +1,63 @@
 #include "QuadNode.h"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
 
-QuadNode::QuadNode(Rectangle boundary, quadnodekey_t key, quadnodeaddr_t ne, quadnodeaddr_t nw, quadnodeaddr_t se, quadnodeaddr_t sw, Point *ponto) : _boundary(boundary), key(INVALIDKEY), ne(ne), nw(nw), se(se), sw(sw), _point(ponto)
+/**
+ * @brief Converte um limite inferior para float sem ultrapassar o valor original.
+ */
+static float floorToFloat(double v)
+{
+    float f = static_cast<float>(v);
+    return (f > v) ? std::nextafter(f, -INFINITY) : f;
+}
+
+/**
+ * @brief Converte um limite superior para float sem ficar abaixo do valor original.
+ */
+static float ceilToFloat(double v)
+{
+    float f = static_cast<float>(v);
+    return (f < v) ? std::nextafter(f, INFINITY) : f;
+}
+
+QuadNode::QuadNode(const Rectangle &boundary)
+    : _x(0), _y(0),
+      _lbx(floorToFloat(boundary.getLB().getX())), _lby(floorToFloat(boundary.getLB().getY())),
+      _rtx(ceilToFloat(boundary.getRT().getX())), _rty(ceilToFloat(boundary.getRT().getY())),
+      ne(INVALIDADDR), nw(INVALIDADDR), se(INVALIDADDR), sw(INVALIDADDR),
+      _activeCount(0), _pointCount(0), _bucket(INVALIDBUCKET), _bucketCount(0), _hasPoint(false), _active(false)
 {
 }
 
 void QuadNode::reset()
 {
-    key = INVALIDKEY;
     ne = nw = se = sw = INVALIDADDR;
-    _point = nullptr;
+    _activeCount = 0;
+    _pointCount = 0;
+    _bucket = INVALIDBUCKET;
+    _bucketCount = 0;
+    _hasPoint = false;
+    _active = false;
+}
+
+double QuadNode::distanceSquared(const Point &p) const
+{
+    double dx = _x - p.getX();
+    double dy = _y - p.getY();
+    return dx * dx + dy * dy;
 }
 
 quadnodeaddr_t QuadNodeManager::createNode(const QuadNode &pn)
 {
+    if (firstAvail != INVALIDADDR)
+    {
+        quadnodeaddr_t addr = firstAvail;
+        firstAvail = nodes[addr].ne;
+        _numFree--;
+        nodes[addr] = pn;
+        return addr;
+    }
     nodes[_size++] = pn;
     return _size - 1; // Retorna o índice do novo nó
 }
@@ -21,7 +66,15 @@ void QuadNodeManager::deleteNode(quadnodeaddr_t addr)
 {
     if (addr >= 0 && static_cast<size_t>(addr) < _size)
     {
+        if (nodes[addr]._bucket != INVALIDBUCKET)
+        {
+            freeBuckets.push_back(nodes[addr]._bucket);
+        }
         nodes[addr].reset();
+        stations[addr] = INVALIDSTATION;
+        nodes[addr].ne = firstAvail;
+        firstAvail = addr;
+        _numFree++;
     }
 }
 
@@ -29,77 +82,334 @@ void QuadNodeManager::putNode(quadnodeaddr_t addr, QuadNode &pn)
 {
     if (addr >= 0 && static_cast<size_t>(addr) < _size)
     {
-        pn.key = addr;
         nodes[addr] = pn;
     }
 }
 
-QuadNode QuadNodeManager::getNode(quadnodeaddr_t addr) const
+Point QuadNodeManager::getPoint(quadnodeaddr_t addr) const
+{
+    if (addr >= 0 && static_cast<size_t>(addr) < _size)
+    {
+        return Point(nodes[addr]._x, nodes[addr]._y, stations[addr], nodes[addr]._active);
+    }
+    return Point();
+}
+
+void QuadNodeManager::setPoint(quadnodeaddr_t addr, const Point &p)
+{
+    if (addr >= 0 && static_cast<size_t>(addr) < _size)
+    {
+        stations[addr] = p.getId();
+        nodes[addr]._x = p.getX();
+        nodes[addr]._y = p.getY();
+        nodes[addr]._hasPoint = true;
+        nodes[addr]._active = p.isActive();
+    }
+}
+
+bool QuadNodeManager::holds(quadnodeaddr_t addr, const Point &p) const
+{
+    const QuadNode &node = getNode(addr);
+    return node._hasPoint && stations[addr] == p.getId() && node._x == p.getX() && node._y == p.getY();
+}
+
+int32_t QuadNodeManager::createBucket()
+{
+    if (!freeBuckets.empty())
+    {
+        int32_t bucket = freeBuckets.back();
+        freeBuckets.pop_back();
+        return bucket;
+    }
+
+    int32_t bucket = bucketX.size() / _bucketSize;
+    size_t size = bucketX.size() + _bucketSize;
+    bucketX.resize(size);
+    bucketY.resize(size);
+    bucketStations.resize(size, INVALIDSTATION);
+    bucketActive.resize(size);
+    return bucket;
+}
+
+void QuadNodeManager::addToBucket(quadnodeaddr_t addr, const Point &p)
+{
+    QuadNode &node = nodes[addr];
+    if (node._bucket == INVALIDBUCKET)
+    {
+        node._bucket = createBucket();
+    }
+
+    long slot = static_cast<long>(node._bucket) * _bucketSize + node._bucketCount++;
+    bucketX[slot] = p.getX();
+    bucketY[slot] = p.getY();
+    bucketStations[slot] = p.getId();
+    bucketActive[slot] = p.isActive();
+}
+
+void QuadNodeManager::takeBucket(quadnodeaddr_t addr, std::vector<Point> &out)
+{
+    QuadNode &node = nodes[addr];
+    if (node._bucket == INVALIDBUCKET)
+    {
+        return;
+    }
+
+    long base = static_cast<long>(node._bucket) * _bucketSize;
+    for (long slot = base; slot < base + node._bucketCount; slot++)
+    {
+        out.push_back(getBucketPoint(slot));
+    }
+    freeBuckets.push_back(node._bucket);
+    node._bucket = INVALIDBUCKET;
+    node._bucketCount = 0;
+}
+
+void QuadNodeManager::removeFromBucket(quadnodeaddr_t addr, long slot)
+{
+    QuadNode &node = nodes[addr];
+    long last = static_cast<long>(node._bucket) * _bucketSize + --node._bucketCount;
+    bucketX[slot] = bucketX[last];
+    bucketY[slot] = bucketY[last];
+    bucketStations[slot] = bucketStations[last];
+    bucketActive[slot] = bucketActive[last];
+    if (node._bucketCount == 0)
+    {
+        freeBuckets.push_back(node._bucket);
+        node._bucket = INVALIDBUCKET;
+    }
+}
+
+long QuadNodeManager::bucketSlot(quadnodeaddr_t addr, const Point &p) const
+{
+    const QuadNode &node = getNode(addr);
+    long base = static_cast<long>(node._bucket) * _bucketSize;
+    for (long slot = base; slot < base + node._bucketCount; slot++)
+    {
+        if (bucketStations[slot] == p.getId() && bucketX[slot] == p.getX() && bucketY[slot] == p.getY())
+        {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+Point QuadNodeManager::getBucketPoint(long slot) const
+{
+    return Point(bucketX[slot], bucketY[slot], bucketStations[slot], bucketActive[slot]);
+}
+
+const QuadNode &QuadNodeManager::getNode(quadnodeaddr_t addr) const
 {
+    static const QuadNode emptyNode(Rectangle(Point(0, 0), Point(0, 0))); // Retornado para endereços inválidos
     if (addr >= 0 && static_cast<size_t>(addr) < _size)
     {
         return nodes[addr];
     }
-    return QuadNode(Rectangle(Point(0, 0), Point(0, 0)));
+    return emptyNode;
 }
 
-void QuadNodeManager::initialize(long capacity)
+void QuadNodeManager::initialize(long capacity, int bucketSize)
 {
     _capacity = capacity;
-    nodes = new QuadNode[_capacity];
+    _bucketSize = std::max(0, std::min(bucketSize, MAXBUCKETSIZE));
+
+    // C++11 não tem new alinhado: reserva a memória alinhada à linha de cache e constrói os nós nela
+    void *mem = nullptr;
+    if (posix_memalign(&mem, alignof(QuadNode), _capacity * sizeof(QuadNode)) != 0)
+    {
+        throw std::bad_alloc();
+    }
+    nodes = static_cast<QuadNode *>(mem);
+    for (size_t i = 0; i < _capacity; i++)
+    {
+        new (&nodes[i]) QuadNode();
+    }
+    stations = new stationidx_t[_capacity];
+    std::fill(stations, stations + _capacity, INVALIDSTATION);
 }
 
 void QuadNodeManager::destroy()
 {
-    delete[] nodes;
+    free(nodes);
+    delete[] stations;
+    nodes = nullptr;
+    stations = nullptr;
 }
 
-quadnodeaddr_t QuadNodeManager::localize(quadnodeaddr_t addr, const Point &p)
+int QuadNodeManager::quadrant(quadnodeaddr_t addr, const Point &p) const
+{
+    const QuadNode &node = nodes[addr];
+
+    // Os quadrantes são fechados e compartilham as bordas: a ordem dos testes decide os empates
+    bool east = p.getX() >= node._x;
+    bool west = p.getX() <= node._x;
+    bool north = p.getY() >= node._y;
+    bool south = p.getY() <= node._y;
+
+    if (east && north)
+    {
+        return NE;
+    }
+    else if (west && north)
+    {
+        return NW;
+    }
+    else if (west && south)
+    {
+        return SW;
+    }
+    return SE;
+}
+
+Rectangle QuadNodeManager::quadrantBoundary(quadnodeaddr_t addr, int q) const
+{
+    const QuadNode &node = nodes[addr];
+
+    switch (q)
+    {
+    case NE:
+        return Rectangle(Point(node._x, node._y), Point(node._rtx, node._rty));
+    case NW:
+        return Rectangle(Point(node._lbx, node._y), Point(node._x, node._rty));
+    case SW:
+        return Rectangle(Point(node._lbx, node._lby), Point(node._x, node._y));
+    default:
+        return Rectangle(Point(node._x, node._lby), Point(node._rtx, node._y));
+    }
+}
+
+void QuadNodeManager::permute(const std::vector<quadnodeaddr_t> &newAddr)
 {
-    QuadNode nx = getNode(addr);
-    Rectangle _boundary = nx._boundary;
-    Point *_point = nx._point;
-    Point mid(_point->getX(), _point->getY());
+    // Os nós são copiados para fora do vetor e reescritos em ordem crescente de endereço
+    std::vector<stationidx_t> oldStations(stations, stations + _size);
+    std::vector<quadnodeaddr_t> oldAddr(_size);
+    for (size_t i = 0; i < _size; i++)
+    {
+        oldAddr[newAddr[i]] = i;
+    }
 
-    Rectangle neRet = Rectangle(mid, Point(_boundary.getRT().getX(), _boundary.getRT().getY()));
-    Rectangle nwRet = Rectangle(Point(_boundary.getLB().getX(), mid.getY()), Point(mid.getX(), _boundary.getRT().getY()));
-    Rectangle swRet = Rectangle(Point(_boundary.getLB().getX(), _boundary.getLB().getY()), mid);
-    Rectangle seRet = Rectangle(Point(mid.getX(), _boundary.getLB().getY()), Point(_boundary.getRT().getX(), mid.getY()));
+    // Como em initialize, a cópia dos nós precisa de memória alinhada à linha de cache, que std::vector não
+    // garante em C++11
+    void *mem = nullptr;
+    if (posix_memalign(&mem, alignof(QuadNode), _size * sizeof(QuadNode)) != 0)
+    {
+        throw std::bad_alloc();
+    }
+    QuadNode *oldNodes = static_cast<QuadNode *>(mem);
+    for (size_t i = 0; i < _size; i++)
+    {
+        new (&oldNodes[i]) QuadNode(nodes[i]);
+    }
 
-    if (_boundary.contains(p))
+    for (size_t i = 0; i < _size; i++)
     {
-        if (neRet.contains(p))
+        QuadNode node = oldNodes[oldAddr[i]];
+        quadnodeaddr_t *children[4] = {&node.ne, &node.nw, &node.sw, &node.se};
+        for (quadnodeaddr_t *child : children)
         {
-            if (nodes[addr].ne == INVALIDADDR)
+            if (*child != INVALIDADDR)
             {
-                nodes[addr].ne = createNode(QuadNode(neRet));
+                *child = newAddr[*child];
             }
-            return nodes[addr].ne;
         }
-        else if (nwRet.contains(p))
+        nodes[i] = node;
+        stations[i] = oldStations[oldAddr[i]];
+    }
+    free(oldNodes);
+
+    // Os baldes passam a seguir a ordem das folhas, para que folhas vizinhas no vetor de nós também tenham
+    // seus pontos próximos na memória
+    std::vector<double> oldX, oldY;
+    std::vector<stationidx_t> oldBucketStations;
+    std::vector<uint8_t> oldActive;
+    oldX.swap(bucketX);
+    oldY.swap(bucketY);
+    oldBucketStations.swap(bucketStations);
+    oldActive.swap(bucketActive);
+    freeBuckets.clear();
+    bucketX.reserve(oldX.size());
+    bucketY.reserve(oldY.size());
+    bucketStations.reserve(oldBucketStations.size());
+    bucketActive.reserve(oldActive.size());
+
+    for (size_t i = 0; i < _size; i++)
+    {
+        QuadNode &node = nodes[i];
+        if (node._bucket == INVALIDBUCKET)
+        {
+            continue;
+        }
+        long from = static_cast<long>(node._bucket) * _bucketSize;
+        node._bucket = createBucket();
+        long to = static_cast<long>(node._bucket) * _bucketSize;
+        std::copy(oldX.begin() + from, oldX.begin() + from + _bucketSize, bucketX.begin() + to);
+        std::copy(oldY.begin() + from, oldY.begin() + from + _bucketSize, bucketY.begin() + to);
+        std::copy(oldBucketStations.begin() + from, oldBucketStations.begin() + from + _bucketSize, bucketStations.begin() + to);
+        std::copy(oldActive.begin() + from, oldActive.begin() + from + _bucketSize, bucketActive.begin() + to);
+    }
+}
+
+void QuadNodeManager::truncate(size_t size)
+{
+    for (size_t i = size; i < _size; i++)
+    {
+        nodes[i] = QuadNode();
+        stations[i] = INVALIDSTATION;
+    }
+    _size = size;
+    firstAvail = INVALIDADDR;
+    _numFree = 0;
+}
+
+size_t QuadNodeManager::size() const
+{
+    return _size - _numFree;
+}
+
+quadnodeaddr_t QuadNodeManager::localize(quadnodeaddr_t addr, const Point &p)
+{
+    switch (quadrant(addr, p))
+    {
+    case NE:
+        if (nodes[addr].ne == INVALIDADDR)
+        {
+            nodes[addr].ne = createNode(QuadNode(quadrantBoundary(addr, NE)));
+        }
+        return nodes[addr].ne;
+    case NW:
+        if (nodes[addr].nw == INVALIDADDR)
         {
-            if (nodes[addr].nw == INVALIDADDR)
-            {
-                nodes[addr].nw = createNode(QuadNode(nwRet));
-            }
-            return nodes[addr].nw;
+            nodes[addr].nw = createNode(QuadNode(quadrantBoundary(addr, NW)));
         }
-        else if (swRet.contains(p))
+        return nodes[addr].nw;
+    case SW:
+        if (nodes[addr].sw == INVALIDADDR)
         {
-            if (nodes[addr].sw == INVALIDADDR)
-            {
-                nodes[addr].sw = createNode(QuadNode(swRet));
-            }
-            return nodes[addr].sw;
+            nodes[addr].sw = createNode(QuadNode(quadrantBoundary(addr, SW)));
         }
-        else if (seRet.contains(p))
+        return nodes[addr].sw;
+    case SE:
+        if (nodes[addr].se == INVALIDADDR)
         {
-            if (nodes[addr].se == INVALIDADDR)
-            {
-                nodes[addr].se = createNode(QuadNode(seRet));
-            }
-            return nodes[addr].se;
+            nodes[addr].se = createNode(QuadNode(quadrantBoundary(addr, SE)));
         }
+        return nodes[addr].se;
+    }
+    return INVALIDADDR;
+}
+
+quadnodeaddr_t QuadNodeManager::child(quadnodeaddr_t addr, const Point &p) const
+{
+    switch (quadrant(addr, p))
+    {
+    case NE:
+        return nodes[addr].ne;
+    case NW:
+        return nodes[addr].nw;
+    case SW:
+        return nodes[addr].sw;
+    case SE:
+        return nodes[addr].se;
     }
     return INVALIDADDR;
-}
\ No newline at end of file
+}